@@ -0,0 +1,465 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batching_sender.h"
+#include "buffer_pool.h"
+#include "channel.h"
+#include "channel_handles.h"
+#include "combining_channel.h"
+#include "numa_channel.h"
+#include "signal_channel.h"
+
+// Verifies the allocation-free guarantee: once constructed, bounded channels
+// and selectors over them never allocate, and unbounded channels stop
+// allocating once they reached their peak size. Every allocation of the
+// process goes through the counters below, and a check fails if any happens
+// while it is armed.
+
+namespace {
+
+std::atomic<bool> armed{false};
+std::atomic<size_t> hot_allocations{0};
+
+void count_allocation() {
+    if (armed.load(std::memory_order_relaxed)) {
+        hot_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace
+
+// Replacing the global operator new catches the C++ allocations
+void* operator new(size_t size) {
+    count_allocation();
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    count_allocation();
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+    count_allocation();
+    size_t align = static_cast<size_t>(alignment);
+    size_t rounded = (size + align - 1) / align * align;
+    if (void* p = std::aligned_alloc(align, rounded)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#if defined(__GLIBC__)
+// glibc exports its allocator under these names, so malloc itself can be
+// interposed to catch C allocations as well
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+    count_allocation();
+    return __libc_malloc(size);
+}
+void* calloc(size_t count, size_t size) {
+    count_allocation();
+    return __libc_calloc(count, size);
+}
+void* realloc(void* p, size_t size) {
+    count_allocation();
+    return __libc_realloc(p, size);
+}
+void* aligned_alloc(size_t alignment, size_t size) {
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+}
+#endif
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+/**
+ * @brief Runs body with the counters armed and fails if it allocated.
+ * Threads must be started before and joined after, since creating a
+ * thread allocates.
+ */
+template <typename Body>
+void expect_no_allocations(const std::string& what, Body body) {
+    hot_allocations = 0;
+    armed = true;
+    body();
+    armed = false;
+    size_t count = hot_allocations.load();
+    if (count != 0) {
+        log(what + ": " + std::to_string(count) + " allocation(s)");
+    }
+    assert(count == 0 && "Hot path allocated");
+}
+
+/**
+ * @brief Streams values through a channel from a second thread, exercising
+ * the blocking, non-blocking, timed, status and batch operations.
+ */
+template <typename Ch>
+void exercise(const std::string& what, Ch& ch) {
+    constexpr int kValues = 20000;
+    std::atomic<bool> go{false};
+    long long received = 0;
+    std::thread consumer([&ch, &go, &received] {
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+        int block[8];
+        int value;
+        for (;;) {
+            if (size_t n = ch.receive_batch(block, 8)) {
+                for (size_t i = 0; i < n; ++i) {
+                    received += block[i];
+                }
+            } else {
+                break;
+            }
+            if (ch.try_receive_status(value) == ChannelStatus::ok) {
+                received += value;
+            }
+            if (ch.receive_status_for(value, std::chrono::microseconds(10)) ==
+                ChannelStatus::ok) {
+                received += value;
+            }
+            if (auto v = ch.try_receive()) {
+                received += *v;
+            }
+        }
+    });
+
+    CancellationToken token;
+    expect_no_allocations(what, [&] {
+        go = true;
+        int batch[4] = {1, 1, 1, 1};
+        for (int i = 0; i < kValues; i += 8) {
+            ch.send(1);
+            ch.send(1, token);
+            ch.send_status(1);
+            ch.send_status_for(1, std::chrono::seconds(1));
+            ch.send_batch(batch, 4);
+        }
+        while (!ch.try_send(0)) {
+            std::this_thread::yield();
+        }
+        ch.try_send_status(0);
+        while (!ch.is_empty()) {
+            std::this_thread::yield();
+        }
+        ch.close();
+        // Operations on a closed channel report it without allocating
+        assert(ch.send_status(1) == ChannelStatus::closed);
+    });
+    consumer.join();
+    assert(received == kValues && "Lost values");
+}
+
+void test_ring_channels() {
+    log("Testing allocation-free ring channels");
+    using namespace channel_policy;
+    SpscChannel<int> spsc(16);
+    exercise("SpscChannel", spsc);
+    SpscChannel<int, spin> spsc_spin(16);
+    exercise("SpscChannel<spin>", spsc_spin);
+    SpscChannel<int, poll> spsc_poll(16);
+    exercise("SpscChannel<poll>", spsc_poll);
+    MpscChannel<int> mpsc(16);
+    exercise("MpscChannel", mpsc);
+    Channel<int, ChannelPolicy<multi, multi, bounded_ring, adaptive>> ring(16);
+    exercise("adaptive ring", ring);
+    StaticChannel<int, 16> fixed;
+    exercise("StaticChannel", fixed);
+    SpscChannel<int> placed(16, StorageOptions::on_node(0));
+    exercise("SpscChannel on node 0", placed);
+    log("Ring channel test completed");
+}
+
+struct Large {
+    char bytes[200];
+    int id;
+};
+
+void test_growable_channels() {
+    log("Testing allocation-free growable channels");
+    // Bounded channels asked to reserve their capacity at construction
+    Channel<int> buffered(16, StorageOptions::preallocated());
+    exercise("Channel", buffered);
+    AdaptiveChannel<int> adaptive(16, StorageOptions::preallocated());
+    exercise("AdaptiveChannel", adaptive);
+    // Queued senders wait on the stack
+    FairChannel<int> fair(16, StorageOptions::preallocated());
+    exercise("FairChannel", fair);
+
+    // Unbounded channels stop allocating once they reached their peak size
+    UnboundedChannel<int> unbounded;
+    for (int i = 0; i < 32768; ++i) {
+        unbounded.send(0);
+    }
+    while (unbounded.try_receive()) {
+    }
+    exercise("UnboundedChannel", unbounded);
+
+    // Large elements go to the slab, which is reserved the same way
+    Channel<Large> slab(8, StorageOptions::preallocated());
+    std::thread consumer([&slab] {
+        int expected = 0;
+        while (auto value = slab.receive()) {
+            assert(value->id == expected++);
+        }
+        assert(expected == 10000);
+    });
+    expect_no_allocations("Channel<Large>", [&] {
+        for (int i = 0; i < 10000; ++i) {
+            slab.send(Large{{}, i});
+        }
+        slab.close();
+    });
+    consumer.join();
+
+    // Draining a slab that grew over several chunks returns every slot to
+    // the free list without growing it
+    UnboundedChannel<Large> grown;
+    for (int i = 0; i < 1000; ++i) {
+        grown.send(Large{{}, i});
+    }
+    expect_no_allocations("UnboundedChannel<Large> drain", [&] {
+        for (int i = 0; i < 1000; ++i) {
+            assert(grown.try_receive()->id == i);
+        }
+    });
+    log("Growable channel test completed");
+}
+
+void test_handles_and_numa() {
+    log("Testing allocation-free handles and NUMA channel");
+    auto [tx, rx] = make_channel<int>(16);
+    NumaChannel<int> numa(16);
+    std::atomic<bool> go{false};
+    long long received = 0;
+    long long numa_received = 0;
+    std::thread consumer([&, rx = std::move(rx)] {
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+        while (auto value = rx.receive()) {
+            received += *value;
+        }
+    });
+    std::thread numa_consumer([&] {
+        while (auto value = numa.receive()) {
+            numa_received += *value;
+        }
+    });
+    expect_no_allocations("handles and NumaChannel", [&] {
+        go = true;
+        Sender<int> second = tx;  // Copying a handle only counts it
+        for (int i = 0; i < 10000; ++i) {
+            tx.send(1);
+            second.send(1);
+            numa.send(1);
+        }
+        second.reset();
+        tx.reset();  // Closes the channel
+        while (numa.size() > 0) {
+            std::this_thread::yield();
+        }
+        numa.close();
+    });
+    consumer.join();
+    numa_consumer.join();
+    assert(received == 20000 && numa_received == 10000 && "Lost values");
+    log("Handle and NUMA channel test completed");
+}
+
+void test_selector() {
+    log("Testing allocation-free selector");
+    SpscChannel<int> a(8);
+    Channel<int, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                               channel_policy::bounded_ring>>
+        b(8);
+    Selector selector;
+    long long sum = 0;
+    // Registration allocates; selecting does not
+    selector.add_receive<int>(a, [&sum](int value) { sum += value; });
+    selector.add_receive<int>(b, [&sum](int value) { sum += value; });
+    CancellationToken token;
+    std::thread select_thread([&] { selector.select(token); });
+
+    expect_no_allocations("Selector", [&] {
+        for (int i = 0; i < 10000; ++i) {
+            a.send(1);
+            b.send(2);
+        }
+        a.close();
+        b.close();
+    });
+    select_thread.join();
+    assert(sum == 30000 && "Selector missed values");
+    log("Selector test completed");
+}
+
+void test_buffer_pool() {
+    log("Testing allocation-free pooled buffers");
+    BufferPool<> pool(8, 256);
+    Channel<PooledBuffer<>, ChannelPolicy<channel_policy::single,
+                                          channel_policy::single,
+                                          channel_policy::bounded_ring>>
+        ch(8);
+    long long received = 0;
+    std::thread consumer([&] {
+        while (auto message = ch.receive()) {
+            for (uint8_t byte : **message) {
+                received += byte;
+            }
+        }
+    });
+    // Filling a buffer and returning it only reuses its storage
+    expect_no_allocations("BufferPool", [&] {
+        for (int i = 0; i < 10000; ++i) {
+            auto buffer = pool.acquire();
+            buffer->assign(200, 1);
+            ch.send(std::move(buffer));
+        }
+        ch.close();
+    });
+    consumer.join();
+    assert(received == 2000000 && "Lost bytes");
+    log("Buffer pool test completed");
+}
+
+void test_batching_sender() {
+    log("Testing allocation-free batching sender");
+    Channel<int> ch(64, StorageOptions::preallocated());
+    long long received = 0;
+    std::thread consumer([&] {
+        int block[16];
+        while (size_t n = ch.receive_batch(block, 16)) {
+            for (size_t i = 0; i < n; ++i) {
+                received += block[i];
+            }
+        }
+    });
+    // The batch buffer is reserved when the handle is constructed
+    BatchingSender<int> batch(ch, 32, std::chrono::microseconds(50));
+    expect_no_allocations("BatchingSender", [&] {
+        for (int i = 0; i < 10000; ++i) {
+            batch.send(1);
+        }
+        batch.flush();
+        ch.close();
+    });
+    consumer.join();
+    assert(received == 10000 && "Lost values");
+    log("Batching sender test completed");
+}
+
+void test_combining_channel() {
+    log("Testing allocation-free combining channel");
+    CombiningChannel<int> ch(16);
+    long long received = 0;
+    std::thread consumer([&] {
+        while (auto value = ch.receive()) {
+            received += *value;
+        }
+    });
+    expect_no_allocations("CombiningChannel", [&] {
+        for (int i = 0; i < 10000; ++i) {
+            ch.send(1);
+        }
+        while (!ch.is_empty()) {
+            std::this_thread::yield();
+        }
+        ch.close();
+    });
+    consumer.join();
+    assert(received == 10000 && "Lost values");
+    log("Combining channel test completed");
+}
+
+void test_signal_channel() {
+    log("Testing allocation-free signal channel");
+    SignalChannel signals;
+    long long received = 0;
+    std::thread waiter([&] {
+        while (signals.wait()) {
+            received++;
+        }
+    });
+    expect_no_allocations("SignalChannel", [&] {
+        for (int i = 0; i < 10000; ++i) {
+            signals.notify();
+        }
+        while (!signals.is_empty()) {
+            std::this_thread::yield();
+        }
+        signals.close();
+    });
+    waiter.join();
+    assert(received == 10000 && "Lost signals");
+    log("Signal channel test completed");
+}
+
+void test_harness_detects_allocations() {
+    log("Testing that the harness catches an allocation");
+    hot_allocations = 0;
+    armed = true;
+    auto* leak = new std::vector<int>(100);
+    armed = false;
+    delete leak;
+    assert(hot_allocations.load() >= 2);
+    log("Harness test completed");
+}
+
+int main() {
+    log("Starting allocation tests");
+
+    test_harness_detects_allocations();
+    test_ring_channels();
+    test_growable_channels();
+    test_handles_and_numa();
+    test_selector();
+    test_buffer_pool();
+    test_batching_sender();
+    test_combining_channel();
+    test_signal_channel();
+
+    log("All tests completed successfully");
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "batching_sender.h"
+
+template <typename T, typename Policy>
+BatchingSender<T, Policy>::BatchingSender(Channel<T, Policy>& channel,
+                                          size_t batch_size,
+                                          std::chrono::nanoseconds linger)
+    : channel(&channel), capacity(batch_size), linger(linger) {
+    if (batch_size == 0) {
+        throw std::invalid_argument("Batch size must be greater than 0");
+    }
+    buffer.reserve(batch_size);  // Appending never allocates afterwards
+}
+
+template <typename T, typename Policy>
+BatchingSender<T, Policy>::BatchingSender(const Sender<T, Policy>& sender,
+                                          size_t batch_size,
+                                          std::chrono::nanoseconds linger)
+    : sender(sender), capacity(batch_size), linger(linger) {
+    if (batch_size == 0) {
+        throw std::invalid_argument("Batch size must be greater than 0");
+    }
+    buffer.reserve(batch_size);
+}
+
+template <typename T, typename Policy>
+BatchingSender<T, Policy>::BatchingSender(BatchingSender&& other) noexcept
+    : channel(std::exchange(other.channel, nullptr)),
+      sender(std::move(other.sender)),
+      buffer(std::move(other.buffer)),
+      capacity(other.capacity),
+      linger(other.linger),
+      oldest(other.oldest) {
+    other.buffer.clear();
+}
+
+template <typename T, typename Policy>
+BatchingSender<T, Policy>::~BatchingSender() {
+    try {
+        flush();
+    } catch (const std::runtime_error&) {
+        // Closed channel: nobody is left to receive the values
+    }
+}
+
+template <typename T, typename Policy>
+void BatchingSender<T, Policy>::send(const T& value) {
+    buffer.push_back(value);
+    after_append();
+}
+
+template <typename T, typename Policy>
+void BatchingSender<T, Policy>::send(T&& value) {
+    buffer.push_back(std::move(value));
+    after_append();
+}
+
+template <typename T, typename Policy>
+void BatchingSender<T, Policy>::after_append() {
+    if (buffer.size() >= capacity) {
+        flush();
+    } else if (linger != std::chrono::nanoseconds::zero()) {
+        // One clock read per value, only when a linger time is set
+        auto now = std::chrono::steady_clock::now();
+        if (buffer.size() == 1) {
+            oldest = now;
+        } else if (now - oldest >= linger) {
+            flush();
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void BatchingSender<T, Policy>::flush() {
+    if (buffer.empty()) {
+        return;
+    }
+    struct Clear {
+        std::vector<T>& buffer;
+        ~Clear() { buffer.clear(); }
+    } clear{buffer};
+    if (channel) {
+        channel->send_batch(buffer.data(), buffer.size());
+    } else if (sender) {
+        sender.send_batch(buffer.data(), buffer.size());
+    }
+}
+
+template <typename T, typename Policy>
+bool BatchingSender<T, Policy>::flush_if_due() {
+    if (buffer.empty() ||
+        std::chrono::steady_clock::now() - oldest < linger) {
+        return false;
+    }
+    flush();
+    return true;
+}
@@ -0,0 +1,142 @@
+#ifndef BATCHING_SENDER_H
+#define BATCHING_SENDER_H
+
+#include <chrono>
+#include <vector>
+
+#include "channel.h"
+#include "channel_handles.h"
+
+/**
+ * @brief A producer-side handle that collects values and sends them to a
+ * channel in batches.
+ *
+ * send() only appends to a buffer owned by the handle. The buffer goes to the
+ * channel with a single send_batch() when it holds batch_size values, when
+ * flush() is called, when the oldest buffered value has waited longer than
+ * the linger time, and when the handle is destroyed. One lock acquisition and
+ * one wakeup are paid per batch instead of per value, at the cost of the
+ * values waiting in the buffer until it is flushed.
+ *
+ * The handle is not thread-safe: give each producer thread its own. Values of
+ * one handle are received in order; values of different handles interleave
+ * batch by batch.
+ *
+ * The value type and policy are deduced from the channel or Sender, so the
+ * handle of a make_channel() Sender needs no template arguments.
+ *
+ * @tparam T The type of the values. Must be copyable.
+ * @tparam Policy The policy of the underlying channel.
+ */
+template <typename T, typename Policy = ChannelPolicy<>>
+class BatchingSender {
+   public:
+    /**
+     * @brief Constructs a BatchingSender sending to a channel.
+     * @param channel The channel. Must outlive the handle.
+     * @param batch_size The number of values that triggers a send. Must be
+     * greater than 0.
+     * @param linger How long a buffered value may wait for its batch to
+     * fill, checked when sending. Zero disables the check.
+     * @throws std::invalid_argument if batch_size is 0.
+     *
+     * Use Case: Many producers sending small values one at a time into a
+     * shared channel.
+     * Example: BatchingSender events(ch, 64, std::chrono::microseconds(100));
+     *          events.send(event);
+     */
+    BatchingSender(Channel<T, Policy>& channel, size_t batch_size,
+                   std::chrono::nanoseconds linger =
+                       std::chrono::nanoseconds::zero());
+
+    /**
+     * @brief Constructs a BatchingSender sending through a Sender handle. The
+     * handle keeps a copy of the Sender, so the channel closes once this
+     * handle is destroyed if it held the last one.
+     * @param sender The Sender.
+     * @param batch_size The number of values that triggers a send.
+     * @param linger How long a buffered value may wait, or zero.
+     */
+    BatchingSender(const Sender<T, Policy>& sender, size_t batch_size,
+                   std::chrono::nanoseconds linger =
+                       std::chrono::nanoseconds::zero());
+
+    BatchingSender(BatchingSender&& other) noexcept;
+    BatchingSender& operator=(BatchingSender&&) = delete;
+    BatchingSender(const BatchingSender&) = delete;
+    BatchingSender& operator=(const BatchingSender&) = delete;
+
+    /**
+     * @brief Flushes the buffered values. Values that can no longer be
+     * delivered because the channel was closed are dropped.
+     */
+    ~BatchingSender();
+
+    /**
+     * @brief Buffers a value, sending the batch if it is full or its linger
+     * time has passed.
+     * @param value The value to send.
+     * @throws std::runtime_error if a send happens and the channel is closed.
+     */
+    void send(const T& value);
+    void send(T&& value);
+
+    /**
+     * @brief Sends the buffered values. Blocks while the channel is full.
+     * @throws std::runtime_error if the channel is closed. The buffered
+     * values are discarded.
+     *
+     * Example: events.send(last);
+     *          events.flush();  // Before waiting for replies
+     */
+    void flush();
+
+    /**
+     * @brief Sends the buffered values if the oldest has lingered long
+     * enough. For producers that go idle while values are buffered.
+     * @return true if a batch was sent.
+     */
+    bool flush_if_due();
+
+    /**
+     * @brief Returns the number of buffered values.
+     */
+    size_t pending() const { return buffer.size(); }
+
+    /**
+     * @brief Returns the number of values that triggers a send.
+     */
+    size_t batch_size() const { return capacity; }
+
+   private:
+    /**
+     * @brief Sends the batch if appending the last value filled it or made
+     * it overdue.
+     */
+    void after_append();
+
+    Channel<T, Policy>* channel = nullptr;  // Null when sending via sender
+    Sender<T, Policy> sender;
+    std::vector<T> buffer;
+    size_t capacity;
+    std::chrono::nanoseconds linger;
+    std::chrono::steady_clock::time_point oldest;  // Of the buffered values
+};
+
+template <typename T, typename Policy>
+BatchingSender(Channel<T, Policy>&, size_t, std::chrono::nanoseconds)
+    -> BatchingSender<T, Policy>;
+
+template <typename T, typename Policy>
+BatchingSender(Channel<T, Policy>&, size_t) -> BatchingSender<T, Policy>;
+
+template <typename T, typename Policy>
+BatchingSender(const Sender<T, Policy>&, size_t, std::chrono::nanoseconds)
+    -> BatchingSender<T, Policy>;
+
+template <typename T, typename Policy>
+BatchingSender(const Sender<T, Policy>&, size_t) -> BatchingSender<T, Policy>;
+
+#include "batching_sender.cc"
+
+#endif  // BATCHING_SENDER_H
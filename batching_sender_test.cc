@@ -0,0 +1,119 @@
+#include "batching_sender.h"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+void test_flush_triggers() {
+    log("Testing batch flush triggers");
+    Channel<int> ch(16);
+    {
+        BatchingSender<int> batch(ch, 4);
+        for (int i = 0; i < 3; ++i) {
+            batch.send(i);
+        }
+        // Buffered, not sent
+        assert(batch.pending() == 3 && ch.is_empty());
+        batch.send(3);
+        assert(batch.pending() == 0 && ch.size() == 4);
+
+        batch.send(4);
+        batch.flush();
+        assert(ch.size() == 5);
+        batch.send(5);
+        assert(ch.size() == 5);
+    }
+    // Destruction flushed the last value
+    assert(ch.size() == 6);
+    for (int i = 0; i < 6; ++i) {
+        assert(*ch.receive() == i);
+    }
+    log("Flush trigger test completed");
+}
+
+void test_linger() {
+    log("Testing linger time");
+    Channel<int> ch(16);
+    BatchingSender<int> batch(ch, 100, std::chrono::milliseconds(20));
+    batch.send(1);
+    assert(!batch.flush_if_due());
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    // The next send finds the first value overdue and sends both
+    batch.send(2);
+    assert(batch.pending() == 0 && ch.size() == 2);
+
+    batch.send(3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    assert(batch.flush_if_due() && ch.size() == 3);
+    log("Linger test completed");
+}
+
+void test_many_producers() {
+    log("Testing batching producers");
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 10000;
+    auto [tx, rx] = make_channel<int>(64);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([p, tx = tx] {
+            BatchingSender batch(tx, 32);
+            for (int i = 0; i < kPerProducer; ++i) {
+                batch.send(p * kPerProducer + i);
+            }
+        });
+    }
+    tx.reset();  // The producers' handles keep the channel open
+
+    std::vector<int> last(kProducers, -1);
+    long long count = 0;
+    while (auto value = rx.receive()) {
+        // Each producer's values arrive in order
+        int p = *value / kPerProducer;
+        assert(*value > last[p]);
+        last[p] = *value;
+        count++;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    assert(count == kProducers * kPerProducer && "Lost values");
+    log("Batching producer test completed");
+}
+
+void test_closed_channel() {
+    log("Testing batching into a closed channel");
+    Channel<std::string> ch(4);
+    BatchingSender<std::string> batch(ch, 8);
+    batch.send("dropped");
+    ch.close();
+    bool threw = false;
+    try {
+        batch.flush();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && batch.pending() == 0);
+    batch.send("also dropped");  // The destructor does not throw
+    log("Closed channel test completed");
+}
+
+int main() {
+    log("Starting batching sender tests");
+
+    test_flush_triggers();
+    test_linger();
+    test_many_producers();
+    test_closed_channel();
+
+    log("All tests completed successfully");
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "buffer_pool.h"
+
+namespace detail {
+
+template <typename Buffer, typename = void>
+struct HasClear : std::false_type {};
+template <typename Buffer>
+struct HasClear<Buffer, std::void_t<decltype(std::declval<Buffer&>().clear())>>
+    : std::true_type {};
+
+template <typename Buffer, typename = void>
+struct HasReserve : std::false_type {};
+template <typename Buffer>
+struct HasReserve<
+    Buffer, std::void_t<decltype(std::declval<Buffer&>().reserve(size_t()))>>
+    : std::true_type {};
+
+}  // namespace detail
+
+template <typename Buffer>
+void PooledBuffer<Buffer>::release() {
+    if (buffer) {
+        pool->recycle(std::exchange(buffer, nullptr));
+        pool = nullptr;
+    }
+}
+
+template <typename Buffer>
+BufferPool<Buffer>::BufferPool(size_t count, size_t reserve)
+    : buffers(count), free_list(count == 0 ? 1 : count) {
+    if (count == 0) {
+        throw std::invalid_argument("A buffer pool needs at least one buffer");
+    }
+    for (Buffer& buffer : buffers) {
+        if constexpr (detail::HasReserve<Buffer>::value) {
+            buffer.reserve(reserve);
+        }
+        free_list.try_send(&buffer);
+    }
+}
+
+template <typename Buffer>
+typename BufferPool<Buffer>::Handle BufferPool<Buffer>::acquire() {
+    // The free list is never closed while the pool exists
+    return Handle(this, *free_list.receive());
+}
+
+template <typename Buffer>
+std::optional<typename BufferPool<Buffer>::Handle>
+BufferPool<Buffer>::try_acquire() {
+    Buffer* buffer;
+    if (free_list.try_receive_status(buffer) != ChannelStatus::ok) {
+        return std::nullopt;
+    }
+    return Handle(this, buffer);
+}
+
+template <typename Buffer>
+template <typename Rep, typename Period>
+std::optional<typename BufferPool<Buffer>::Handle>
+BufferPool<Buffer>::acquire_for(
+    const std::chrono::duration<Rep, Period>& timeout) {
+    Buffer* buffer;
+    if (free_list.receive_status_for(buffer, timeout) != ChannelStatus::ok) {
+        return std::nullopt;
+    }
+    return Handle(this, buffer);
+}
+
+template <typename Buffer>
+void BufferPool<Buffer>::recycle(Buffer* buffer) {
+    if constexpr (detail::HasClear<Buffer>::value) {
+        buffer->clear();  // Keeps the capacity for the next message
+    }
+    free_list.try_send(buffer);
+}
@@ -0,0 +1,158 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "channel.h"
+
+template <typename Buffer = std::vector<uint8_t>>
+class BufferPool;
+
+/**
+ * @brief A buffer borrowed from a BufferPool.
+ *
+ * Move-only: it can be moved through a channel like any other value. When the
+ * last owner destroys it or calls release(), the buffer is cleared and sent
+ * back to the pool's free list, whatever thread that happens on.
+ *
+ * @tparam Buffer The type of the pooled buffers.
+ */
+template <typename Buffer = std::vector<uint8_t>>
+class PooledBuffer {
+   public:
+    PooledBuffer() = default;
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : pool(std::exchange(other.pool, nullptr)),
+          buffer(std::exchange(other.buffer, nullptr)) {}
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            pool = std::exchange(other.pool, nullptr);
+            buffer = std::exchange(other.buffer, nullptr);
+        }
+        return *this;
+    }
+    ~PooledBuffer() { release(); }
+
+    /**
+     * @brief Returns the buffer to its pool. The handle is empty afterwards.
+     */
+    void release();
+
+    /**
+     * @brief Checks if the handle holds a buffer.
+     */
+    explicit operator bool() const { return buffer != nullptr; }
+
+    Buffer& operator*() const { return *buffer; }
+    Buffer* operator->() const { return buffer; }
+    Buffer* get() const { return buffer; }
+
+   private:
+    friend class BufferPool<Buffer>;
+    PooledBuffer(BufferPool<Buffer>* pool, Buffer* buffer)
+        : pool(pool), buffer(buffer) {}
+
+    BufferPool<Buffer>* pool = nullptr;
+    Buffer* buffer = nullptr;
+};
+
+/**
+ * @brief A fixed set of reusable buffers whose free list is a channel.
+ *
+ * Producers acquire a buffer, fill it and send the PooledBuffer through a
+ * channel. The consumer drops it when done, which sends the buffer back
+ * through the pool's return channel, ready for the next acquire(). Buffers
+ * are cleared but keep their capacity, so once the pool is sized for the
+ * number of messages in flight, passing a message costs no allocation and
+ * no cross-thread free.
+ *
+ * The pool must outlive every PooledBuffer taken from it.
+ *
+ * @tparam Buffer The type of the pooled buffers. Cleared with clear() when
+ * it has one.
+ */
+template <typename Buffer>
+class BufferPool {
+   public:
+    using Handle = PooledBuffer<Buffer>;
+
+    /**
+     * @brief Constructs a BufferPool object.
+     * @param count The number of buffers. Must be greater than 0.
+     * @param reserve Capacity reserved in each buffer up front, for buffers
+     * with a reserve() member.
+     * @throws std::invalid_argument if count is 0.
+     *
+     * Use Case: Reuse message payloads instead of allocating one per message
+     * on the producer and freeing it on the consumer.
+     * Example: BufferPool<> pool(64, 4096);
+     */
+    explicit BufferPool(size_t count, size_t reserve = 0);
+
+    // Disable copying and moving: handles point back to the pool
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+    BufferPool(BufferPool&&) = delete;
+    BufferPool& operator=(BufferPool&&) = delete;
+
+    /**
+     * @brief Takes a free buffer, waiting for one to be released if all are
+     * in use.
+     * @return The buffer, empty but with its capacity intact.
+     *
+     * Example: auto buffer = pool.acquire();
+     *          buffer->assign(data, data + size);
+     *          ch.send(std::move(buffer));
+     */
+    Handle acquire();
+
+    /**
+     * @brief Takes a free buffer without waiting.
+     * @return The buffer, or std::nullopt if all are in use.
+     */
+    std::optional<Handle> try_acquire();
+
+    /**
+     * @brief Takes a free buffer, waiting at most the given duration.
+     * @return The buffer, or std::nullopt if none was released in time.
+     */
+    template <typename Rep, typename Period>
+    std::optional<Handle> acquire_for(
+        const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Returns the number of buffers in the pool.
+     */
+    size_t capacity() const { return buffers.size(); }
+
+    /**
+     * @brief Returns the number of buffers not in use. A snapshot when other
+     * threads acquire or release.
+     */
+    size_t available() const { return free_list.size(); }
+
+   private:
+    friend class PooledBuffer<Buffer>;
+
+    /**
+     * @brief Clears a buffer and puts it back on the free list.
+     */
+    void recycle(Buffer* buffer);
+
+    std::vector<Buffer> buffers;  // Never resized, so addresses are stable
+    // The return channel: always has room, since it holds every buffer
+    Channel<Buffer*, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                                   channel_policy::bounded_ring>>
+        free_list;
+};
+
+#include "buffer_pool.cc"
+
+#endif  // BUFFER_POOL_H
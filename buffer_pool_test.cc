@@ -0,0 +1,101 @@
+#include "buffer_pool.h"
+
+#include <cassert>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+void test_acquire_and_release() {
+    log("Testing acquire and release");
+    BufferPool<> pool(2, 128);
+    assert(pool.capacity() == 2);
+    assert(pool.available() == 2);
+    {
+        auto a = pool.acquire();
+        assert(a && a->empty() && a->capacity() >= 128);
+        a->push_back(1);
+        auto b = pool.try_acquire();
+        assert(b && pool.available() == 0);
+        // Exhausted: non-blocking and timed acquires give up
+        assert(!pool.try_acquire());
+        assert(!pool.acquire_for(std::chrono::milliseconds(10)));
+
+        uint8_t* data = a->data();
+        a.release();
+        assert(!a && pool.available() == 1);
+        // The same buffer comes back, cleared but with its storage
+        auto c = pool.acquire();
+        assert(c->empty() && c->data() == data);
+    }
+    assert(pool.available() == 2);
+
+    // Moving a handle transfers ownership; assigning over one returns it
+    auto d = pool.acquire();
+    auto e = std::move(d);
+    assert(!d && e && pool.available() == 1);
+    e = pool.acquire();
+    assert(pool.available() == 1);
+    log("Acquire and release test completed");
+}
+
+void test_handles_through_channel() {
+    log("Testing pooled buffers passed through a channel");
+    constexpr int kMessages = 10000;
+    BufferPool<std::string> pool(4);
+    Channel<PooledBuffer<std::string>> ch(4);
+    std::set<std::string*> seen;
+
+    std::thread consumer([&ch] {
+        int expected = 0;
+        while (auto message = ch.receive()) {
+            assert(**message == std::to_string(expected++));
+            // Dropping the handle returns the buffer to the producer's pool
+        }
+        assert(expected == kMessages);
+    });
+
+    for (int i = 0; i < kMessages; ++i) {
+        auto buffer = pool.acquire();  // Waits for the consumer to release
+        seen.insert(buffer.get());
+        *buffer = std::to_string(i);
+        ch.send(std::move(buffer));
+    }
+    ch.close();
+    consumer.join();
+    // Only the pool's buffers were ever used
+    assert(seen.size() <= pool.capacity());
+    assert(pool.available() == pool.capacity());
+    log("Channel test completed");
+}
+
+void test_invalid_count() {
+    log("Testing an empty pool");
+    bool threw = false;
+    try {
+        BufferPool<> pool(0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    log("Empty pool test completed");
+}
+
+int main() {
+    log("Starting buffer pool tests");
+
+    test_acquire_and_release();
+    test_handles_through_channel();
+    test_invalid_count();
+
+    log("All tests completed successfully");
+    return 0;
+}
@@ -0,0 +1,155 @@
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+template <typename F>
+class CancellationCallback;
+
+/**
+ * @brief A shared flag used to cancel blocked channel operations.
+ *
+ * Copies of a token share the same state, so one copy can be handed to the
+ * blocking operations while another is kept by whoever decides to cancel.
+ * Cancelling wakes only the operations waiting on this token; the channels
+ * they were waiting on stay open for everyone else.
+ *
+ * Use Case: Abort a single blocked send/receive during request cancellation
+ * or shutdown without closing a shared channel.
+ * Example:
+ * CancellationToken token;
+ * std::thread t([&] { auto v = ch.receive(token); });
+ * token.cancel();  // receive() returns std::nullopt right away
+ */
+class CancellationToken {
+   public:
+    CancellationToken() : state(std::make_shared<State>()) {}
+
+    /**
+     * @brief Cancels the token and runs all registered callbacks, waking
+     * every operation waiting on it. Cancelling twice has no effect.
+     *
+     * @note Must not be called while holding the lock of a channel or
+     * selector that is waiting on this token.
+     */
+    void cancel() const {
+        std::unique_lock<std::mutex> lock(state->mtx);
+        if (state->cancelled.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        // Callbacks stay registered until they have run; a concurrent
+        // unregistration waits on the lock held here.
+        for (Node* node = state->head; node; node = node->next) {
+            node->invoke(node->owner);
+        }
+    }
+
+    /**
+     * @brief Checks if the token has been cancelled. Never blocks.
+     */
+    bool is_cancelled() const {
+        return state->cancelled.load(std::memory_order_acquire);
+    }
+
+   private:
+    template <typename F>
+    friend class CancellationCallback;
+
+    // Intrusive list node owned by a CancellationCallback, so registering a
+    // callback never allocates.
+    struct Node {
+        void (*invoke)(void*) = nullptr;
+        void* owner = nullptr;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+    };
+
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::mutex mtx;
+        Node* head = nullptr;
+    };
+
+    /**
+     * @brief Links a node into the callback list.
+     * @return false if the token is already cancelled.
+     */
+    bool add(Node* node) const {
+        std::unique_lock<std::mutex> lock(state->mtx);
+        if (state->cancelled.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        node->next = state->head;
+        if (state->head) {
+            state->head->prev = node;
+        }
+        state->head = node;
+        return true;
+    }
+
+    /**
+     * @brief Unlinks a node. Waits for a running cancel() to finish.
+     */
+    void remove(Node* node) const {
+        std::unique_lock<std::mutex> lock(state->mtx);
+        if (node->prev) {
+            node->prev->next = node->next;
+        } else {
+            state->head = node->next;
+        }
+        if (node->next) {
+            node->next->prev = node->prev;
+        }
+    }
+
+    std::shared_ptr<State> state;
+};
+
+/**
+ * @brief Registers a callback that runs when a token is cancelled.
+ *
+ * The callback runs on the cancelling thread, or immediately if the token is
+ * already cancelled. It is unregistered on destruction, which waits for a
+ * callback that is currently running to finish.
+ *
+ * @tparam F The type of the callback.
+ */
+template <typename F>
+class CancellationCallback {
+   public:
+    CancellationCallback(const CancellationToken& token, F callback)
+        : token(token), callback(std::move(callback)) {
+        node.invoke = [](void* self) {
+            static_cast<CancellationCallback*>(self)->callback();
+        };
+        node.owner = this;
+        registered = token.add(&node);
+        if (!registered) {
+            this->callback();
+        }
+    }
+
+    // Disable copying and moving
+    CancellationCallback(const CancellationCallback&) = delete;
+    CancellationCallback& operator=(const CancellationCallback&) = delete;
+    CancellationCallback(CancellationCallback&&) = delete;
+    CancellationCallback& operator=(CancellationCallback&&) = delete;
+
+    // Destructor
+    ~CancellationCallback() {
+        if (registered) {
+            token.remove(&node);
+        }
+    }
+
+   private:
+    CancellationToken::Node node;
+    CancellationToken token;
+    F callback;
+    bool registered;
+};
+
+#endif  // CANCELLATION_TOKEN_H
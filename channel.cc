@@ -1,174 +1,1005 @@
 #include "channel.h"
 
-template <typename T>
-void Channel<T>::send(const T& value) {
-    std::unique_lock<std::mutex> lock(mtx);
-    if (closed) {
+template <typename T, typename Policy>
+void Channel<T, Policy>::send(const T& value) {
+    if (send_impl(value, nullptr, nullptr) == ChannelStatus::closed) {
+        throw std::runtime_error("Send on closed channel");
+    }
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::send(T&& value) {
+    if (send_impl(std::move(value), nullptr, nullptr) ==
+        ChannelStatus::closed) {
+        throw std::runtime_error("Send on closed channel");
+    }
+}
+
+template <typename T, typename Policy>
+bool Channel<T, Policy>::send(const T& value, const CancellationToken& token) {
+    ChannelStatus status = send_status(value, token);
+    if (status == ChannelStatus::closed) {
         throw std::runtime_error("Send on closed channel");
     }
-    if (capacity == 0) {
-        // For unbuffered channels, wait until there's a receiver or the channel
-        // is closed
-        cv_send.wait(lock, [this] { return waitingReceivers > 0 || closed; });
+    return status == ChannelStatus::ok;
+}
+
+template <typename T, typename Policy>
+ChannelStatus Channel<T, Policy>::send_status(const T& value) noexcept(
+    nothrow_send) {
+    return send_impl(value, nullptr, nullptr);
+}
+
+template <typename T, typename Policy>
+ChannelStatus Channel<T, Policy>::send_status(T&& value) noexcept(
+    nothrow_move_send) {
+    return send_impl(std::move(value), nullptr, nullptr);
+}
+
+template <typename T, typename Policy>
+ChannelStatus Channel<T, Policy>::send_status(
+    const T& value, const CancellationToken& token) noexcept(nothrow_send) {
+    // Registered before taking mtx, so cancel() never waits on a lock we hold
+    CancelWaiter waiter(token);
+    CancellationCallback on_cancel(token,
+                                   [this, &waiter] { wake_for_cancel(waiter); });
+    return send_impl(value, &waiter, nullptr);
+}
+
+template <typename T, typename Policy>
+template <typename Rep, typename Period>
+ChannelStatus Channel<T, Policy>::send_status_for(
+    const T& value,
+    const std::chrono::duration<Rep, Period>& timeout) noexcept(nothrow_send) {
+    Deadline deadline =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
+    return send_impl(value, nullptr, &deadline);
+}
+
+template <typename T, typename Policy>
+template <typename U>
+ChannelStatus Channel<T, Policy>::send_impl(U&& value, CancelWaiter* waiter,
+                                            const Deadline* deadline) {
+    if constexpr (kMayRendezvous && std::is_lvalue_reference_v<U> &&
+                  std::is_copy_constructible_v<T> &&
+                  !std::is_nothrow_copy_constructible_v<T>) {
+        if (is_rendezvous()) {
+            // A receiver pairing through elimination may be in a noexcept
+            // receive, so it only moves. Copy here, where a throwing copy
+            // reaches the sender.
+            T staged(value);
+            return send_impl(std::move(staged), waiter, deadline);
+        }
+    }
+    typename decltype(producerCheck)::Guard guard(producerCheck);
+    auto cancelled = [waiter] {
+        return waiter && waiter->token.is_cancelled();
+    };
+
+    if constexpr (Policy::lock_free) {
+        for (;;) {
+            {
+                auto side = producer_lock();
+                if (closed) {
+                    return ChannelStatus::closed;
+                }
+                if (cancelled()) {
+                    return ChannelStatus::cancelled;
+                }
+                if (!queue.full()) {
+                    queue.push(std::forward<U>(value));
+                    break;
+                }
+            }
+            // Another producer may take the slot first, so check again after
+            // waking up
+            bool ready = park(
+                sendersWaiting, cv_send, waiter,
+                [this, &cancelled] {
+                    return !queue.full() || closed || cancelled();
+                },
+                deadline);
+            if (!ready) {
+                return ChannelStatus::timeout;
+            }
+        }
+        wake_peer(receiversWaiting, cv_recv, true);
+        return ChannelStatus::ok;
+    } else {
+        if constexpr (kMayRendezvous) {
+            // Pair with a receiver directly, unless one is already blocked on
+            // the locked path, which serves it at once
+            if (is_rendezvous() &&
+                waitingReceivers.load(std::memory_order_relaxed) == 0 &&
+                !closed && !cancelled() &&
+                offer_for_elimination(std::forward<U>(value), cancelled)) {
+                return ChannelStatus::ok;
+            }
+        }
+        auto lock = lock_channel();
+        if (closed) {
+            return ChannelStatus::closed;
+        }
+        bool ready;
+        if (is_rendezvous()) {
+            // For unbuffered channels, wait until there's a receiver or the
+            // channel is closed
+            ready = wait(
+                lock, cv_send, waiter,
+                [this, &cancelled] {
+                    return waitingReceivers > 0 || closed || cancelled();
+                },
+                deadline);
+        } else {
+            // For buffered channels, wait until there's space in the buffer or
+            // the channel is closed
+            ready = wait_for_slot(lock, cancelled, waiter, deadline);
+        }
         if (closed) {
-            throw std::runtime_error("Channel closed while waiting to send");
+            return ChannelStatus::closed;
         }
-        --waitingReceivers;
-        queue.push(value);
+        if (cancelled()) {
+            if (ready) {
+                notify_senders(1);  // Pass a slot handed to us on
+            }
+            return ChannelStatus::cancelled;
+        }
+        if (!ready) {
+            return ChannelStatus::timeout;
+        }
+        if (is_rendezvous()) {
+            --waitingReceivers;
+        }
+        queue.push(std::forward<U>(value));
         cv_recv.notify_one();  // Notify a waiting receiver
-        // Notify all registered selectors
-        for (auto selector : selectors) {
-            selector->notify();
+        notify_selectors();
+        return ChannelStatus::ok;
+    }
+}
+
+template <typename T, typename Policy>
+std::future<void> Channel<T, Policy>::async_send(const T& value) {
+    // Launch an asynchronous task to send the value
+    return std::async(std::launch::async, [this, value] { this->send(value); });
+}
+
+template <typename T, typename Policy>
+std::future<bool> Channel<T, Policy>::async_send(const T& value,
+                                                 CancellationToken token) {
+    return std::async(std::launch::async, [this, value, token] {
+        return this->send(value, token);
+    });
+}
+
+template <typename T, typename Policy>
+bool Channel<T, Policy>::try_send(const T& value) {
+    return try_send_impl(value) == ChannelStatus::ok;
+}
+
+template <typename T, typename Policy>
+bool Channel<T, Policy>::try_send(T&& value) {
+    return try_send_impl(std::move(value)) == ChannelStatus::ok;
+}
+
+template <typename T, typename Policy>
+ChannelStatus Channel<T, Policy>::try_send_status(const T& value) noexcept(
+    nothrow_send) {
+    return try_send_impl(value);
+}
+
+template <typename T, typename Policy>
+ChannelStatus Channel<T, Policy>::try_send_status(T&& value) noexcept(
+    nothrow_move_send) {
+    return try_send_impl(std::move(value));
+}
+
+template <typename T, typename Policy>
+template <typename U>
+ChannelStatus Channel<T, Policy>::try_send_impl(U&& value) {
+    typename decltype(producerCheck)::Guard guard(producerCheck);
+    if constexpr (Policy::lock_free) {
+        {
+            auto side = producer_lock();
+            if (closed) {
+                return ChannelStatus::closed;
+            }
+            if (queue.full()) {
+                return ChannelStatus::full;
+            }
+            queue.push(std::forward<U>(value));
         }
+        wake_peer(receiversWaiting, cv_recv, true);
+        return ChannelStatus::ok;
     } else {
-        // For buffered channels, wait until there's space in the buffer or the
-        // channel is closed
-        cv_send.wait(lock,
-                     [this] { return queue.size() < capacity || closed; });
+        // Fail without the lock when the answer is already known
+        if (closed.load(std::memory_order_acquire)) {
+            return ChannelStatus::closed;
+        }
+        if (!is_rendezvous() && buffer_full()) {
+            return ChannelStatus::full;
+        }
+        auto lock = lock_channel();
         if (closed) {
-            throw std::runtime_error("Channel closed while waiting to send");
+            return ChannelStatus::closed;
+        }
+        if (!is_rendezvous() && is_full()) {
+            return ChannelStatus::full;
         }
-        queue.push(value);
+        if constexpr (Policy::fifo_senders) {
+            if (sendHead) {
+                return ChannelStatus::full;  // Do not overtake blocked senders
+            }
+        }
+        queue.push(std::forward<U>(value));
         cv_recv.notify_one();  // Notify a waiting receiver
-        // Notify all registered selectors
-        for (auto selector : selectors) {
-            selector->notify();
+        notify_selectors();
+        return ChannelStatus::ok;
+    }
+}
+
+template <typename T, typename Policy>
+std::optional<T> Channel<T, Policy>::receive() {
+    std::optional<T> result;
+    receive_impl([&result](T&& value) { result.emplace(std::move(value)); },
+                 nullptr, nullptr);
+    return result;
+}
+
+template <typename T, typename Policy>
+std::optional<T> Channel<T, Policy>::receive(const CancellationToken& token) {
+    // Registered before taking mtx, so cancel() never waits on a lock we hold
+    CancelWaiter waiter(token);
+    CancellationCallback on_cancel(token,
+                                   [this, &waiter] { wake_for_cancel(waiter); });
+    std::optional<T> result;
+    receive_impl([&result](T&& value) { result.emplace(std::move(value)); },
+                 &waiter, nullptr);
+    return result;
+}
+
+template <typename T, typename Policy>
+ChannelStatus Channel<T, Policy>::receive_status(T& out) noexcept(
+    nothrow_receive) {
+    return receive_impl([&out](T&& value) { out = std::move(value); }, nullptr,
+                        nullptr);
+}
+
+template <typename T, typename Policy>
+ChannelStatus Channel<T, Policy>::receive_status(
+    T& out, const CancellationToken& token) noexcept(nothrow_receive) {
+    CancelWaiter waiter(token);
+    CancellationCallback on_cancel(token,
+                                   [this, &waiter] { wake_for_cancel(waiter); });
+    return receive_impl([&out](T&& value) { out = std::move(value); }, &waiter,
+                        nullptr);
+}
+
+template <typename T, typename Policy>
+template <typename Rep, typename Period>
+ChannelStatus Channel<T, Policy>::receive_status_for(
+    T& out,
+    const std::chrono::duration<Rep, Period>& timeout) noexcept(
+    nothrow_receive) {
+    Deadline deadline =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
+    return receive_impl([&out](T&& value) { out = std::move(value); }, nullptr,
+                        &deadline);
+}
+
+template <typename T, typename Policy>
+template <typename Sink>
+ChannelStatus Channel<T, Policy>::receive_impl(Sink sink, CancelWaiter* waiter,
+                                               const Deadline* deadline) {
+    typename decltype(consumerCheck)::Guard guard(consumerCheck);
+    adopt_consumer_node();
+    auto cancelled = [waiter] {
+        return waiter && waiter->token.is_cancelled();
+    };
+
+    if constexpr (Policy::lock_free) {
+        for (;;) {
+            {
+                auto side = consumer_lock();
+                if (cancelled()) {
+                    return ChannelStatus::cancelled;
+                }
+                // Read closed first: a push made before close() is then
+                // visible, so values sent before close() are still delivered
+                bool was_closed = closed;
+                if (!queue.empty()) {
+                    sink(queue.pop());
+                    break;
+                }
+                if (was_closed) {
+                    return ChannelStatus::closed;
+                }
+            }
+            bool ready = park(
+                receiversWaiting, cv_recv, waiter,
+                [this, &cancelled] {
+                    return !queue.empty() || closed || cancelled();
+                },
+                deadline);
+            if (!ready) {
+                return ChannelStatus::timeout;
+            }
         }
+        wake_peer(sendersWaiting, cv_send, false);
+        return ChannelStatus::ok;
+    } else {
+        if constexpr (kMayRendezvous) {
+            if (is_rendezvous() && !cancelled() && take_eliminated(sink)) {
+                return ChannelStatus::ok;
+            }
+        }
+        auto lock = lock_channel();
+        if (is_rendezvous()) {
+            // For unbuffered channels, notify a sender and wait for a value.
+            // The sender that serves us takes care of decrementing
+            // waitingReceivers.
+            ++waitingReceivers;
+            cv_send.notify_one();
+        }
+        // Wait until there's a value, the channel is closed, we are cancelled
+        // or the deadline passes
+        wait(
+            lock, cv_recv, waiter,
+            [this, &cancelled] {
+                return !queue.empty() || closed || cancelled();
+            },
+            deadline);
+        if (queue.empty()) {
+            // Left without being served; withdraw as a receiver
+            if (is_rendezvous() && waitingReceivers > 0) {
+                --waitingReceivers;
+            }
+            if (closed) {
+                return ChannelStatus::closed;
+            }
+            return cancelled() ? ChannelStatus::cancelled
+                               : ChannelStatus::timeout;
+        }
+        sink(queue.pop());
+        notify_senders(1);
+        return ChannelStatus::ok;
     }
 }
 
-template <typename T>
-std::future<void> Channel<T>::async_send(const T& value) {
-    // Launch an asynchronous task to send the value
-    return std::async(std::launch::async, [this, value] { this->send(value); });
+template <typename T, typename Policy>
+std::future<std::optional<T>> Channel<T, Policy>::async_receive() {
+    // Launch an asynchronous task to receive a value
+    return std::async(std::launch::async, [this] { return this->receive(); });
 }
 
-template <typename T>
-bool Channel<T>::try_send(const T& value) {
-    std::unique_lock<std::mutex> lock(mtx);
-    // If the channel is closed or the buffer is full, return false
-    if (closed || (capacity != 0 && queue.size() >= capacity)) {
-        return false;
+template <typename T, typename Policy>
+std::future<std::optional<T>> Channel<T, Policy>::async_receive(
+    CancellationToken token) {
+    return std::async(std::launch::async,
+                      [this, token] { return this->receive(token); });
+}
+
+template <typename T, typename Policy>
+std::optional<T> Channel<T, Policy>::try_receive() {
+    std::optional<T> result;
+    try_receive_impl(
+        [&result](T&& value) { result.emplace(std::move(value)); });
+    return result;
+}
+
+template <typename T, typename Policy>
+ChannelStatus Channel<T, Policy>::try_receive_status(T& out) noexcept(
+    nothrow_receive) {
+    return try_receive_impl([&out](T&& value) { out = std::move(value); });
+}
+
+template <typename T, typename Policy>
+template <typename Sink>
+ChannelStatus Channel<T, Policy>::try_receive_impl(Sink sink) {
+    typename decltype(consumerCheck)::Guard guard(consumerCheck);
+    adopt_consumer_node();
+    if constexpr (Policy::lock_free) {
+        {
+            auto side = consumer_lock();
+            bool was_closed = closed;
+            if (queue.empty()) {
+                return was_closed ? ChannelStatus::closed
+                                  : ChannelStatus::empty;
+            }
+            sink(queue.pop());
+        }
+        wake_peer(sendersWaiting, cv_send, false);
+        return ChannelStatus::ok;
+    } else {
+        if constexpr (kMayRendezvous) {
+            if (is_rendezvous() && take_eliminated(sink)) {
+                return ChannelStatus::ok;
+            }
+        }
+        // Fail without the lock when the answer is already known. Read
+        // closed first: the sends made before close() are then visible.
+        bool was_closed = closed.load(std::memory_order_acquire);
+        if (queue.empty()) {
+            return was_closed ? ChannelStatus::closed : ChannelStatus::empty;
+        }
+        auto lock = lock_channel();
+        if (queue.empty()) {
+            return closed ? ChannelStatus::closed : ChannelStatus::empty;
+        }
+        sink(queue.pop());
+        notify_senders(1);
+        return ChannelStatus::ok;
     }
-    queue.push(value);
-    cv_recv.notify_one();  // Notify a waiting receiver
-    // Notify all registered selectors
-    for (auto selector : selectors) {
-        selector->notify();
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::send_batch(const T* values, size_t count) {
+    if (is_rendezvous()) {
+        // Every value has to meet its own receiver
+        for (size_t i = 0; i < count; ++i) {
+            send(values[i]);
+        }
+        return;
+    }
+    typename decltype(producerCheck)::Guard guard(producerCheck);
+
+    if constexpr (Policy::lock_free) {
+        while (count > 0) {
+            size_t n;
+            {
+                auto side = producer_lock();
+                if (closed) {
+                    throw std::runtime_error("Send on closed channel");
+                }
+                n = std::min(count, free_space());
+                queue.push_n(values, n);
+            }
+            if (n == 0) {
+                park(sendersWaiting, cv_send, nullptr,
+                     [this] { return !queue.full() || closed; });
+                continue;
+            }
+            values += n;
+            count -= n;
+            wake_peer(receiversWaiting, cv_recv, true, n);
+        }
+    } else {
+        auto lock = lock_channel();
+        while (count > 0) {
+            if (closed) {
+                throw std::runtime_error("Send on closed channel");
+            }
+            wait_for_slot(lock, [] { return false; }, nullptr, nullptr);
+            if (closed) {
+                throw std::runtime_error("Channel closed while waiting to send");
+            }
+            size_t n = std::min(count, free_space());
+            queue.push_n(values, n);
+            values += n;
+            count -= n;
+            if (n == 1) {
+                cv_recv.notify_one();
+            } else {
+                cv_recv.notify_all();  // Enough values for several receivers
+            }
+            notify_selectors();
+        }
     }
-    return true;
 }
 
-template <typename T>
-std::optional<T> Channel<T>::receive() {
-    std::unique_lock<std::mutex> lock(mtx);
-    if (capacity == 0) {
-        // For unbuffered channels, notify a sender and wait for a value
-        ++waitingReceivers;
-        cv_send.notify_one();
-        cv_recv.wait(lock, [this] { return !queue.empty() || closed; });
-        --waitingReceivers;
+template <typename T, typename Policy>
+size_t Channel<T, Policy>::try_send_batch(const T* values, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    if (is_rendezvous()) {
+        return try_send(values[0]) ? 1 : 0;
+    }
+    typename decltype(producerCheck)::Guard guard(producerCheck);
+
+    if constexpr (Policy::lock_free) {
+        size_t n;
+        {
+            auto side = producer_lock();
+            n = closed ? 0 : std::min(count, free_space());
+            queue.push_n(values, n);
+        }
+        if (n > 0) {
+            wake_peer(receiversWaiting, cv_recv, true, n);
+        }
+        return n;
     } else {
-        // For buffered channels, wait until there's a value or the channel is
-        // closed
-        cv_recv.wait(lock, [this] { return !queue.empty() || closed; });
+        if (closed.load(std::memory_order_acquire) || buffer_full()) {
+            return 0;
+        }
+        auto lock = lock_channel();
+        size_t n = closed ? 0 : std::min(count, free_space());
+        if (n > 0) {
+            queue.push_n(values, n);
+            cv_recv.notify_all();
+            notify_selectors();
+        }
+        return n;
+    }
+}
+
+template <typename T, typename Policy>
+size_t Channel<T, Policy>::receive_batch(T* out, size_t max) {
+    if (max == 0) {
+        return 0;
     }
-    if (queue.empty() && closed) {
-        return std::nullopt;  // Return empty optional if channel is closed and
-                              // empty
+    if (is_rendezvous()) {
+        // A sender only hands over a value once a receiver is waiting for it
+        auto value = receive();
+        if (!value) {
+            return 0;
+        }
+        out[0] = std::move(*value);
+        return 1;
+    }
+    typename decltype(consumerCheck)::Guard guard(consumerCheck);
+    adopt_consumer_node();
+
+    if constexpr (Policy::lock_free) {
+        size_t n;
+        for (;;) {
+            {
+                auto side = consumer_lock();
+                bool was_closed = closed;
+                n = std::min(max, queue.size());
+                queue.pop_n(out, n);
+                if (n > 0 || was_closed) {
+                    break;
+                }
+            }
+            park(receiversWaiting, cv_recv, nullptr,
+                 [this] { return !queue.empty() || closed; });
+        }
+        if (n > 0) {
+            wake_peer(sendersWaiting, cv_send, false, n);
+        }
+        return n;
+    } else {
+        auto lock = lock_channel();
+        wait(lock, cv_recv, nullptr,
+             [this] { return !queue.empty() || closed; });
+        size_t n = std::min(max, queue.size());
+        queue.pop_n(out, n);
+        notify_senders(n);
+        return n;
     }
-    T value = queue.front();
-    queue.pop();
-    cv_send.notify_one();  // Notify a waiting sender
-    return value;
 }
 
-template <typename T>
-std::future<std::optional<T>> Channel<T>::async_receive() {
-    // Launch an asynchronous task to receive a value
-    return std::async(std::launch::async, [this] { return this->receive(); });
+template <typename T, typename Policy>
+size_t Channel<T, Policy>::try_receive_batch(T* out, size_t max) {
+    typename decltype(consumerCheck)::Guard guard(consumerCheck);
+    adopt_consumer_node();
+
+    if constexpr (Policy::lock_free) {
+        size_t n;
+        {
+            auto side = consumer_lock();
+            n = std::min(max, queue.size());
+            queue.pop_n(out, n);
+        }
+        if (n > 0) {
+            wake_peer(sendersWaiting, cv_send, false, n);
+        }
+        return n;
+    } else {
+        if (queue.empty()) {
+            return 0;
+        }
+        auto lock = lock_channel();
+        size_t n = std::min(max, queue.size());
+        if (n > 0) {
+            queue.pop_n(out, n);
+            notify_senders(n);
+        }
+        return n;
+    }
 }
 
-template <typename T>
-std::optional<T> Channel<T>::try_receive() {
-    std::unique_lock<std::mutex> lock(mtx);
-    if (queue.empty()) {
-        return std::nullopt;  // Return empty optional if queue is empty
+template <typename T, typename Policy>
+typename Channel<T, Policy>::ReceiveIterator Channel<T, Policy>::begin() {
+    return ReceiveIterator(*this);
+}
+
+template <typename T, typename Policy>
+typename Channel<T, Policy>::DrainRange Channel<T, Policy>::drain(
+    size_t batch) {
+    if (batch == 0) {
+        throw std::invalid_argument("Drain batch must be greater than 0");
     }
-    T value = queue.front();
-    queue.pop();
-    cv_send.notify_one();  // Notify a waiting sender
-    return value;
+    return DrainRange(*this, batch);
 }
 
-template <typename T>
-void Channel<T>::close() {
+template <typename T, typename Policy>
+Channel<T, Policy>::DrainIterator::DrainIterator(Channel& channel,
+                                                 size_t batch)
+    : channel(&channel), buffer(make_buffer(channel, batch)) {
+    fill();
+}
+
+template <typename T, typename Policy>
+typename Channel<T, Policy>::DrainIterator::Buffer
+Channel<T, Policy>::DrainIterator::make_buffer(
+    [[maybe_unused]] Channel& channel, [[maybe_unused]] size_t batch) {
+    if constexpr (batched) {
+        // Comes from the channel's resource, like its other buffers
+        return Buffer(batch, channel.selectors.get_allocator());
+    } else {
+        return Buffer();
+    }
+}
+
+template <typename T, typename Policy>
+typename Channel<T, Policy>::DrainIterator&
+Channel<T, Policy>::DrainIterator::operator++() {
+    if (++position == count) {
+        fill();
+    }
+    return *this;
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::DrainIterator::fill() {
+    position = 0;
+    if constexpr (batched) {
+        count = channel->receive_batch(buffer.data(), buffer.size());
+    } else {
+        buffer = channel->receive();
+        count = buffer ? 1 : 0;
+    }
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::close() {
     std::unique_lock<std::mutex> lock(mtx);
     closed = true;
     cv_send.notify_all();  // Notify all waiting senders
+    notify_send_waiters();
     cv_recv.notify_all();  // Notify all waiting receivers
-    // Notify all registered selectors
+    notify_selectors();
+}
+
+template <typename T, typename Policy>
+template <typename Cancelled>
+bool Channel<T, Policy>::wait_for_slot(std::unique_lock<std::mutex>& lock,
+                                       Cancelled cancelled,
+                                       CancelWaiter* waiter,
+                                       const Deadline* deadline) {
+    if constexpr (!Policy::fifo_senders) {
+        return wait(
+            lock, cv_send, waiter,
+            [this, &cancelled] {
+                return !is_full() || closed || cancelled();
+            },
+            deadline);
+    } else {
+        // Senders already queued come first, even if a slot is free
+        if (!sendHead && !is_full()) {
+            return true;
+        }
+        SendWaiter self(waiter);
+        if (sendTail) {
+            sendTail->next = &self;
+        } else {
+            sendHead = &self;
+        }
+        sendTail = &self;
+        wait(
+            lock, self.cv,
+            [&self, this, &cancelled] {
+                return self.granted || closed || cancelled();
+            },
+            deadline);
+        if (self.granted) {
+            // Dequeued by grant_slots(); the reserved slot is ours to fill
+            --reservedSlots;
+            return true;
+        }
+        // Leaving without a slot: unlink ourselves
+        SendWaiter* previous = nullptr;
+        for (SendWaiter* w = sendHead; w != &self; w = w->next) {
+            previous = w;
+        }
+        (previous ? previous->next : sendHead) = self.next;
+        if (sendTail == &self) {
+            sendTail = previous;
+        }
+        return false;
+    }
+}
+
+template <typename T, typename Policy>
+template <typename U, typename Cancelled>
+bool Channel<T, Policy>::offer_for_elimination(U&& value,
+                                               Cancelled cancelled) {
+    EliminationOffer offer;
+    if constexpr (std::is_const_v<std::remove_reference_t<U>> ||
+                  std::is_lvalue_reference_v<U>) {
+        offer.copy_from = &value;
+        offer.move_from = nullptr;
+    } else {
+        offer.copy_from = nullptr;
+        offer.move_from = &value;
+    }
+
+    // Start at a slot of our own, so concurrent senders rarely collide
+    size_t start = detail::thread_index();
+    EliminationSlot* slot = nullptr;
+    for (size_t n = 0; n < kEliminationSlots && !slot; ++n) {
+        EliminationSlot& candidate =
+            elimination[(start + n) % kEliminationSlots];
+        EliminationOffer* empty = nullptr;
+        if (candidate.offer.load(std::memory_order_relaxed) == nullptr &&
+            candidate.offer.compare_exchange_strong(
+                empty, &offer, std::memory_order_release)) {
+            slot = &candidate;
+        }
+    }
+    if (!slot) {
+        return false;  // Every slot holds an offer already
+    }
+
+    detail::Backoff backoff;
+    for (unsigned i = 0; i < kEliminationSpins; ++i) {
+        // A receiver blocked on the locked path will not look at the slots
+        if (offer.state.load(std::memory_order_acquire) !=
+                EliminationOffer::waiting ||
+            waitingReceivers.load(std::memory_order_relaxed) > 0 || closed ||
+            cancelled()) {
+            break;
+        }
+        backoff.pause();
+    }
+
+    EliminationOffer* expected = &offer;
+    if (slot->offer.compare_exchange_strong(expected, nullptr,
+                                            std::memory_order_acq_rel)) {
+        return false;  // Withdrawn before anyone took it
+    }
+    // A receiver claimed the offer; wait until it has the value
+    while (offer.state.load(std::memory_order_acquire) ==
+           EliminationOffer::waiting) {
+        detail::cpu_relax();
+    }
+    return offer.state.load(std::memory_order_relaxed) ==
+           EliminationOffer::taken;
+}
+
+template <typename T, typename Policy>
+template <typename Sink>
+bool Channel<T, Policy>::take_eliminated(Sink& sink) {
+    size_t start = detail::thread_index();
+    for (size_t n = 0; n < kEliminationSlots; ++n) {
+        EliminationSlot& slot = elimination[(start + n) % kEliminationSlots];
+        EliminationOffer* offer = slot.offer.load(std::memory_order_acquire);
+        // The one CAS that pairs us with the sender
+        if (!offer || !slot.offer.compare_exchange_strong(
+                          offer, nullptr, std::memory_order_acq_rel)) {
+            continue;
+        }
+        std::optional<T> value;
+        try {
+            if (offer->move_from) {
+                value.emplace(std::move(*offer->move_from));
+            } else if constexpr (std::is_nothrow_copy_constructible_v<T>) {
+                value.emplace(*offer->copy_from);
+            }
+        } catch (...) {
+            // The sender falls back to the queue
+            offer->state.store(EliminationOffer::rejected,
+                               std::memory_order_release);
+            throw;
+        }
+        // The sender may return as soon as it sees this
+        offer->state.store(EliminationOffer::taken, std::memory_order_release);
+        sink(std::move(*value));
+        return true;
+    }
+    return false;
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::notify_senders(size_t freed) {
+    if constexpr (Policy::fifo_senders) {
+        if (!is_rendezvous()) {
+            grant_slots();
+            return;
+        }
+    }
+    if (freed == 1) {
+        cv_send.notify_one();  // Notify a waiting sender
+    } else if (freed > 1) {
+        cv_send.notify_all();  // Room for several senders
+    }
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::grant_slots() {
+    // The slot is reserved before the sender runs, so a sender arriving in
+    // the meantime finds the channel full
+    while (sendHead && free_space() > 0) {
+        SendWaiter* waiter = sendHead;
+        sendHead = waiter->next;
+        if (!sendHead) {
+            sendTail = nullptr;
+        }
+        waiter->granted = true;
+        ++reservedSlots;
+        waiter->cv.notify_one();
+    }
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::notify_send_waiters() {
+    if constexpr (Policy::fifo_senders) {
+        for (SendWaiter* w = sendHead; w; w = w->next) {
+            w->cv.notify_one();
+        }
+    }
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::notify_selectors() {
     for (auto selector : selectors) {
         selector->notify();
     }
 }
 
-template <typename T>
-void Channel<T>::register_selector(Selector* selector) {
+template <typename T, typename Policy>
+void Channel<T, Policy>::wake_peer(std::atomic<size_t>& waiting,
+                                   WaitList& side, bool pushed, size_t count) {
+    // Pairs with the fence in park(): either the peer sees our update to the
+    // ring before sleeping, or we see its waiting flag and wake it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if constexpr (Policy::blocking) {
+        if (waiting.load(std::memory_order_relaxed) > 0) {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (count > 1) {
+                side.notify_all();  // Enough changed for several waiters
+            } else {
+                side.notify_one();
+            }
+        }
+    }
+    if (pushed && selectorCount.load(std::memory_order_relaxed) > 0) {
+        std::unique_lock<std::mutex> lock(mtx);
+        notify_selectors();
+    }
+}
+
+template <typename T, typename Policy>
+template <typename Predicate>
+bool Channel<T, Policy>::park(std::atomic<size_t>& waiting, WaitList& side,
+                              CancelWaiter* waiter, Predicate pred,
+                              const Deadline* deadline) {
+    if constexpr (Policy::blocking) {
+        std::unique_lock<std::mutex> lock(mtx);
+        waiting.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::condition_variable& cv = waiter ? waiter->cv : side.cv;
+        if (waiter) {
+            side.link(waiter);
+        }
+        bool ready = true;
+        if (deadline) {
+            ready = cv.wait_until(lock, *deadline, pred);
+        } else {
+            cv.wait(lock, pred);
+        }
+        if (waiter) {
+            side.unlink(waiter);
+        }
+        waiting.fetch_sub(1, std::memory_order_relaxed);
+        return ready;
+    } else if constexpr (Policy::polling) {
+        // Watch the counter the peer moves: a receiver waits for the tail, a
+        // sender for the head
+        detail::Poller poller(&waiting == &receiversWaiting
+                                  ? queue.tail_address()
+                                  : queue.head_address());
+        while (!pred()) {
+            if (deadline && Clock::now() >= *deadline) {
+                return false;
+            }
+            poller.wait(pred);
+        }
+        return true;
+    } else {
+        detail::Backoff backoff;
+        while (!pred()) {
+            if (deadline && Clock::now() >= *deadline) {
+                return false;
+            }
+            backoff.pause();
+        }
+        return true;
+    }
+}
+
+template <typename T, typename Policy>
+void Channel<T, Policy>::register_selector(Selector* selector) {
     std::unique_lock<std::mutex> lock(mtx);
     selectors.push_back(selector);
+    selectorCount.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
 }
 
-template <typename T>
-void Channel<T>::unregister_selector(Selector* selector) {
+template <typename T, typename Policy>
+void Channel<T, Policy>::unregister_selector(Selector* selector) {
     std::unique_lock<std::mutex> lock(mtx);
     // Remove the selector from the list
     selectors.erase(std::remove(selectors.begin(), selectors.end(), selector),
                     selectors.end());
+    selectorCount.store(selectors.size(), std::memory_order_relaxed);
 }
 
-template <typename T>
-void Selector::add_receive(Channel<T>& ch, std::function<void(T)> callback) {
+template <typename T, typename Policy, typename Callback>
+void Selector::add_receive(Channel<T, Policy>& ch, Callback callback) {
     std::unique_lock<std::mutex> lock(mtx);
     ch.register_selector(this);
     // Add a lambda function to the channels list
-    channels.push_back([&ch, callback = std::move(callback), this]() mutable {
-        if (ch.is_closed()) {
+    auto poll = [&ch, callback = std::move(callback), this]() mutable {
+        // Drain what is available before looking at the closed state, so
+        // values sent right before close() are not dropped
+        while (auto value = ch.try_receive()) {
+            callback(std::move(*value));  // Hand the received value over
+        }
+        if (ch.is_closed() && ch.is_empty()) {
             ch.unregister_selector(this);
             return true;  // Signal that this channel is done
         }
-        auto value = ch.try_receive();
-        if (value) {
-            callback(*value);  // Call the callback with the received value
-            return false;
-        }
         return false;
-    });
+    };
+    channels.emplace_back(std::move(poll), channels.get_allocator().resource());
 }
 
-void Selector::select() {
-    std::unique_lock<std::mutex> lock(mtx);
+void Selector::select() { select_impl(nullptr); }
+
+bool Selector::select(const CancellationToken& token) {
+    CancellationCallback on_cancel(token, [this] { notify(); });
+    return select_impl(&token);
+}
+
+bool Selector::select_impl(const CancellationToken* token) {
+    auto cancelled = [token] { return token && token->is_cancelled(); };
 
     while (!stop_requested()) {
-        // Wait until a channel has data available or a stop is requested.
-        cv.wait(lock, [this] {
-            return stop_requested() ||
-                   std::any_of(channels.begin(), channels.end(),
-                               [](const auto& ch) { return ch(); });
-        });
+        {
+            // Notifications from here on trigger another pass
+            std::unique_lock<std::mutex> notify_lock(notify_mtx_);
+            notified_ = false;
+        }
 
-        // Process all channels that have data available
-        for (auto ch_it = channels.begin(); ch_it != channels.end();) {
-            if ((*ch_it)()) {
-                // Data processed, remove this channel from the list
-                ch_it = channels.erase(ch_it);
-            } else {
-                ++ch_it;
+        bool done;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            // Process all channels that have data available
+            for (auto ch_it = channels.begin(); ch_it != channels.end();) {
+                if ((*ch_it)()) {
+                    // Channel closed and drained, remove it from the list
+                    ch_it = channels.erase(ch_it);
+                } else {
+                    ++ch_it;
+                }
             }
+            done = channels.empty();
         }
-
-        if (channels.empty()) {
+        if (done) {
             break;
         }
+
+        // Wait until a channel has new data, a stop is requested or we are
+        // cancelled.
+        std::unique_lock<std::mutex> notify_lock(notify_mtx_);
+        cv.wait(notify_lock, [this, &cancelled] {
+            return notified_ || stop_requested() || cancelled();
+        });
+        if (cancelled()) {
+            return false;
+        }
     }
-}
\ No newline at end of file
+    return true;
+}
@@ -1,30 +1,145 @@
 #ifndef CHANNEL_H
 #define CHANNEL_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <future>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
 #include <mutex>
 #include <optional>
 #include <queue>
 #include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "cancellation_token.h"
+#include "channel_policy.h"
+#include "channel_resources.h"
+#include "ring_buffer.h"
+
 class Selector;
 
-template <typename T>
+/**
+ * @brief The outcome of a status-returning channel operation.
+ */
+enum class ChannelStatus {
+    ok,         // The value was sent or received
+    closed,     // The channel is closed (and, for receives, drained)
+    timeout,    // The deadline passed before the operation could complete
+    full,       // try_send_status: the channel has no room right now
+    empty,      // try_receive_status: the channel has no value right now
+    cancelled,  // The cancellation token fired first
+};
+
+/**
+ * @brief A Go-style channel for passing values between threads.
+ *
+ * @tparam T The type of the values.
+ * @tparam Policy A ChannelPolicy declaring producer/consumer cardinality,
+ * storage and wait strategy. The implementation is chosen at compile time:
+ * - One producer and one consumer on a bounded ring use a lock-free ring; the
+ *   mutex is only taken to park a thread when the ring is full or empty.
+ * - Every other combination uses the mutex algorithm over the chosen storage.
+ * - channel_policy::spin replaces sleeping on condition variables with busy
+ *   waiting.
+ * - Unbuffered channels first try to pair a sender with a receiver through a
+ *   small elimination array, where the value changes hands with one CAS and
+ *   neither mtx nor the queue is touched.
+ * - channel_policy::fifo makes senders blocked on a full channel wait in a
+ *   queue, each on its own condition variable. A receive that frees a slot
+ *   reserves it for the oldest waiter, so later senders cannot take it.
+ * - size(), is_empty() and is_closed() never take the mutex, and neither do
+ *   try operations that fail on a full, empty or closed channel.
+ * With assertions enabled, concurrent use of a side declared
+ * channel_policy::single aborts.
+ *
+ * A ring channel, or a bounded dynamic channel constructed with
+ * StorageOptions::preallocated(), allocates its buffer at construction; from
+ * then on, sends and receives (except async_send, async_receive and throwing
+ * on a closed channel) never allocate. Other channels stop allocating once
+ * their buffer reached its peak size.
+ */
+template <typename T, typename Policy>
 class Channel {
    public:
+    using policy_type = Policy;
+
+    // Whether the status-returning sends and receives are noexcept. Sends
+    // can only fail to allocate on the growable storages.
+    static constexpr bool nothrow_send =
+        Policy::ring_storage && std::is_nothrow_copy_constructible_v<T>;
+    static constexpr bool nothrow_move_send =
+        Policy::ring_storage && std::is_nothrow_move_constructible_v<T>;
+    static constexpr bool nothrow_receive =
+        std::is_nothrow_move_constructible_v<T> &&
+        std::is_nothrow_move_assignable_v<T>;
+
     /**
      * @brief Constructs a Channel object.
      * @param cap The capacity of the channel. If 0, creates an unbuffered
-     * channel.
+     * channel. Ignored for unbounded, rendezvous and static_ring storage.
+     * @throws std::invalid_argument if the storage is a bounded ring and cap
+     * is 0.
      *
      * Use Case: Create buffered or unbuffered channels for inter-thread
      * communication. Example: Channel<int> ch(5); // Creates a buffered channel
      * with capacity 5 Channel<std::string> ch; // Creates an unbuffered channel
      */
-    Channel(size_t cap = 0) : capacity(cap) {}
+    Channel(size_t cap = 0) : Channel(cap, StorageOptions()) {}
+
+    /**
+     * @brief Constructs a Channel object that allocates from a memory
+     * resource.
+     * @param cap The capacity of the channel.
+     * @param resource Supplies the buffer and the bookkeeping of the channel:
+     * ring slots, queue chunks and the list of registered selectors. Must
+     * outlive the channel.
+     * @throws std::invalid_argument if the storage is a bounded ring and cap
+     * is 0.
+     *
+     * Use Case: Keep channels off the shared heap, or tear down the channels
+     * of one request by releasing an arena.
+     * Example: Channel<int> ch(0, thread_pool_resource());
+     */
+    Channel(size_t cap, std::pmr::memory_resource* resource)
+        : Channel(cap, StorageOptions(), resource) {}
+
+    /**
+     * @brief Constructs a Channel object whose ring slots are placed
+     * according to options.
+     * @param cap The capacity of the channel.
+     * @param options Where the slots live, used by bounded_ring storage, and
+     * whether dynamic storage reserves its capacity up front. The other
+     * storages ignore it.
+     * @param resource Supplies the memory not covered by options.
+     * @throws std::invalid_argument if the storage is a bounded ring and cap
+     * is 0.
+     * @throws std::length_error if the capacity is to be preallocated but
+     * cannot be addressed.
+     *
+     * Use Case: Keep the buffer of a channel on the NUMA node of the thread
+     * that reads it, so the consumer does not pay for remote memory.
+     * Example: SpscChannel<Tick> ch(4096, StorageOptions::on_node(1));
+     */
+    Channel(
+        size_t cap, const StorageOptions& options,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : queue(make_storage(cap, options, resource)),
+          capacity(Policy::static_capacity ? Policy::static_capacity : cap),
+          selectors(resource) {
+        if constexpr (std::is_same_v<typename Policy::storage,
+                                     channel_policy::dynamic>) {
+            if (options.preallocate) {
+                queue.reserve(cap);  // Never allocates again
+            }
+        }
+    }
 
     // Disable copying and moving
     Channel(const Channel&) = delete;
@@ -48,6 +163,66 @@ class Channel {
      */
     void send(const T& value);
 
+    /**
+     * @brief Moves a value into the channel. Blocks like send(const T&). The
+     * value is left untouched if the channel is closed.
+     * @param value The value to send.
+     * @throws std::runtime_error if the channel is closed.
+     *
+     * Use Case: Pass move-only values, such as pooled buffers or
+     * std::unique_ptr, or avoid copying large ones.
+     * Example: ch.send(std::move(buffer));
+     */
+    void send(T&& value);
+
+    /**
+     * @brief Sends a value to the channel, giving up if the token is
+     * cancelled before the value could be sent.
+     * @param value The value to send.
+     * @param token The token that cancels the operation.
+     * @return true if the value was sent, false if the operation was
+     * cancelled.
+     * @throws std::runtime_error if the channel is closed.
+     *
+     * Use Case: Abort a blocked send without closing a shared channel.
+     * Example: if (!ch.send(42, token)) { // cancelled }
+     */
+    bool send(const T& value, const CancellationToken& token);
+
+    /**
+     * @brief Sends a value to the channel, reporting a closed channel through
+     * the result instead of an exception. Blocks like send().
+     * @param value The value to send.
+     * @return ChannelStatus::ok or ChannelStatus::closed.
+     *
+     * Use Case: Hot paths that must not unwind when the channel is closed
+     * during shutdown.
+     * Example: if (ch.send_status(42) == ChannelStatus::closed) { return; }
+     */
+    ChannelStatus send_status(const T& value) noexcept(nothrow_send);
+    ChannelStatus send_status(T&& value) noexcept(nothrow_move_send);
+
+    /**
+     * @brief Sends a value until the token is cancelled.
+     * @return ChannelStatus::ok, closed or cancelled.
+     */
+    ChannelStatus send_status(const T& value,
+                              const CancellationToken& token) noexcept(
+        nothrow_send);
+
+    /**
+     * @brief Sends a value, waiting at most the given duration for room or a
+     * receiver.
+     * @return ChannelStatus::ok, closed or timeout.
+     *
+     * Example: ch.send_status_for(42, std::chrono::milliseconds(10));
+     */
+    template <typename Rep, typename Period>
+    ChannelStatus send_status_for(
+        const T& value,
+        const std::chrono::duration<Rep, Period>& timeout) noexcept(
+        nothrow_send);
+
     /**
      * @brief Asynchronously sends a value to the channel.
      * @param value The value to send.
@@ -59,6 +234,14 @@ class Channel {
      */
     std::future<void> async_send(const T& value);
 
+    /**
+     * @brief Asynchronously sends a value to the channel until the token is
+     * cancelled.
+     * @return A std::future<bool> that becomes false if the send was
+     * cancelled.
+     */
+    std::future<bool> async_send(const T& value, CancellationToken token);
+
     /**
      * @brief Attempts to send a value to the channel without blocking.
      * @param value The value to send.
@@ -70,6 +253,14 @@ class Channel {
      *          }
      */
     bool try_send(const T& value);
+    bool try_send(T&& value);
+
+    /**
+     * @brief Attempts to send a value without blocking.
+     * @return ChannelStatus::ok, full or closed.
+     */
+    ChannelStatus try_send_status(const T& value) noexcept(nothrow_send);
+    ChannelStatus try_send_status(T&& value) noexcept(nothrow_move_send);
 
     /**
      * @brief Receives a value from the channel. Blocks if the channel is empty.
@@ -84,6 +275,49 @@ class Channel {
      */
     std::optional<T> receive();
 
+    /**
+     * @brief Receives a value from the channel, giving up if the token is
+     * cancelled before a value arrives.
+     * @param token The token that cancels the operation.
+     * @return An optional containing the received value, or std::nullopt if
+     * the operation was cancelled or the channel is closed and empty.
+     *
+     * Use Case: Abort a blocked receive without closing a shared channel.
+     * Example: auto value = ch.receive(token);
+     *          if (!value && token.is_cancelled()) { // cancelled }
+     */
+    std::optional<T> receive(const CancellationToken& token);
+
+    /**
+     * @brief Receives a value into out. Blocks like receive().
+     * @param out Assigned the received value on ChannelStatus::ok, left
+     * untouched otherwise.
+     * @return ChannelStatus::ok or ChannelStatus::closed once the channel is
+     * closed and empty.
+     *
+     * Use Case: Receive into a reused object without an optional.
+     * Example: Message m;
+     *          while (ch.receive_status(m) == ChannelStatus::ok) { use(m); }
+     */
+    ChannelStatus receive_status(T& out) noexcept(nothrow_receive);
+
+    /**
+     * @brief Receives a value into out until the token is cancelled.
+     * @return ChannelStatus::ok, closed or cancelled.
+     */
+    ChannelStatus receive_status(T& out,
+                                 const CancellationToken& token) noexcept(
+        nothrow_receive);
+
+    /**
+     * @brief Receives a value into out, waiting at most the given duration.
+     * @return ChannelStatus::ok, closed or timeout.
+     */
+    template <typename Rep, typename Period>
+    ChannelStatus receive_status_for(
+        T& out, const std::chrono::duration<Rep, Period>& timeout) noexcept(
+        nothrow_receive);
+
     /**
      * @brief Asynchronously receives a value from the channel.
      * @return A std::future containing an optional with the received value.
@@ -93,6 +327,15 @@ class Channel {
      *          auto value = future.get();
      */
     std::future<std::optional<T>> async_receive();
+
+    /**
+     * @brief Asynchronously receives a value from the channel until the token
+     * is cancelled.
+     * @return A std::future containing the received value, or std::nullopt
+     * if the receive was cancelled or the channel is closed and empty.
+     */
+    std::future<std::optional<T>> async_receive(CancellationToken token);
+
     /**
      * @brief Attempts to receive a value from the channel without blocking.
      * @return An optional containing the received value, or std::nullopt if the
@@ -106,6 +349,100 @@ class Channel {
      */
     std::optional<T> try_receive();
 
+    /**
+     * @brief Attempts to receive a value into out without blocking.
+     * @return ChannelStatus::ok, empty, or closed if the channel is closed
+     * and empty.
+     */
+    ChannelStatus try_receive_status(T& out) noexcept(nothrow_receive);
+
+    /**
+     * @brief Sends a batch of values in order. Blocks while the channel is
+     * full, moving as many values as fit at a time. On ring storage a
+     * trivially copyable T is copied with memcpy, in at most two segments per
+     * pass.
+     * @param values The values to send.
+     * @param count The number of values.
+     * @throws std::runtime_error if the channel is closed. Values moved
+     * before the channel was closed stay sent.
+     *
+     * Use Case: Stream numeric data without paying per-element locking.
+     * Example: std::vector<double> samples = read_block();
+     *          ch.send_batch(samples.data(), samples.size());
+     */
+    void send_batch(const T* values, size_t count);
+
+    /**
+     * @brief Sends as many values of a batch as fit without blocking.
+     * @return The number of values sent, 0 if the channel is closed.
+     */
+    size_t try_send_batch(const T* values, size_t count);
+
+    /**
+     * @brief Receives up to max values. Blocks until at least one value is
+     * available, then takes everything that is available up to max.
+     * @param out Where to store the values.
+     * @param max The maximum number of values to receive.
+     * @return The number of values received, 0 if the channel is closed and
+     * empty.
+     *
+     * Use Case: Consume a stream in blocks.
+     * Example: std::vector<double> block(4096);
+     *          while (size_t n = ch.receive_batch(block.data(), block.size()))
+     *          { process(block.data(), n); }
+     */
+    size_t receive_batch(T* out, size_t max);
+
+    /**
+     * @brief Receives up to max available values without blocking.
+     * @return The number of values received.
+     */
+    size_t try_receive_batch(T* out, size_t max);
+
+    class ReceiveIterator;
+    class DrainIterator;
+    class DrainRange;
+
+    /**
+     * @brief The end of a receive loop, reached once the channel is closed
+     * and empty.
+     */
+    struct ReceiveSentinel {};
+
+    // Values drain() takes from the channel at a time by default
+    static constexpr size_t kDrainBatch = 32;
+
+    /**
+     * @brief Starts a loop receiving every value until the channel is closed
+     * and empty. Blocks until the first value arrives.
+     *
+     * Values are received one at a time, so leaving the loop early never
+     * takes a value the body did not see. Use drain() to lock once per batch.
+     *
+     * Use Case: Consume a channel with a range-based for loop.
+     * Example: for (auto&& job : ch) {
+     *              run(job);
+     *          }
+     */
+    ReceiveIterator begin();
+    ReceiveSentinel end() { return {}; }
+
+    /**
+     * @brief Returns a range receiving every value until the channel is
+     * closed and empty, taking up to batch values at a time.
+     * @param batch The number of values taken per receive. Must be greater
+     * than 0.
+     *
+     * The loop locks once per batch instead of once per value. Values taken
+     * but not yet handed out are lost if the loop is left early (break,
+     * return, an exception), so use it for loops that run to the end.
+     *
+     * Example: for (Event& event : ch.drain(256)) {
+     *              record(event);
+     *          }
+     */
+    DrainRange drain(size_t batch = kDrainBatch);
+
     /**
      * @brief Closes the channel. No more values can be sent after closing.
      *
@@ -115,7 +452,8 @@ class Channel {
     void close();
 
     /**
-     * @brief Checks if the channel is closed.
+     * @brief Checks if the channel is closed. Does not take the channel's
+     * lock.
      * @return true if the channel is closed, false otherwise.
      *
      * Use Case: Check the channel state before sending or in a loop.
@@ -124,13 +462,11 @@ class Channel {
      *  // Perform operations
      * }
      */
-    bool is_closed() const {
-        std::unique_lock<std::mutex> lock(mtx);
-        return closed;
-    }
+    bool is_closed() const { return closed.load(std::memory_order_acquire); }
 
     /**
-     * @brief Checks if the channel is empty.
+     * @brief Checks if the channel is empty. Does not take the channel's
+     * lock, so the answer is a snapshot.
      * @return true if the channel is empty, false otherwise.
      *
      * Use Case: Check if there are any pending values in the channel.
@@ -139,24 +475,475 @@ class Channel {
      *  auto value = ch.receive();
      * }
      */
-    bool is_empty() const {
-        std::unique_lock<std::mutex> lock(mtx);
-        return queue.empty();
-    }
+    bool is_empty() const { return queue.empty(); }
 
     /**
-     * @brief Returns the current number of items in the channel.
+     * @brief Returns the current number of items in the channel. Does not
+     * take the channel's lock, so the answer is a snapshot.
      * @return The number of items currently in the channel.
      *
      * Use Case: Check how many items are waiting in the channel.
      * Example: std::cout << "Items in channel: " << ch.size() << "\n";
      */
-    size_t size() const {
-        std::unique_lock<std::mutex> lock(mtx);
-        return queue.size();
+    size_t size() const { return queue.size(); }
+
+    /**
+     * @brief Checks if the channel currently runs its contended path. Always
+     * false unless the wait strategy is channel_policy::adaptive.
+     */
+    bool is_contended() const {
+        if constexpr (Policy::adaptive) {
+            return contention.is_contended();
+        }
+        return false;
     }
 
    private:
+    using Clock = std::chrono::steady_clock;
+    using Deadline = Clock::time_point;
+
+    /**
+     * @brief A blocking operation that can be cancelled. Lives on the
+     * caller's stack. While the operation sleeps it is linked into the
+     * WaitList of its side and waits on its own condition variable, so
+     * cancelling the token wakes this operation and no other.
+     */
+    struct CancelWaiter {
+        explicit CancelWaiter(const CancellationToken& token) : token(token) {}
+
+        const CancellationToken& token;
+        std::condition_variable cv;
+        CancelWaiter* prev = nullptr;
+        CancelWaiter* next = nullptr;
+    };
+
+    /**
+     * @brief The threads blocked on one side of the channel: plain waiters
+     * share cv, cancellable ones are linked in a list. Must be used with mtx
+     * held.
+     */
+    struct WaitList {
+        std::condition_variable cv;
+        CancelWaiter* head = nullptr;
+
+        // Wakes at least one waiter. The oldest cancellable waiter is woken
+        // alongside a plain one, since either may be the one that can go on.
+        void notify_one() {
+            cv.notify_one();
+            if (head) {
+                head->cv.notify_one();
+            }
+        }
+
+        void notify_all() {
+            cv.notify_all();
+            for (CancelWaiter* w = head; w; w = w->next) {
+                w->cv.notify_one();
+            }
+        }
+
+        // Appended, so head stays the oldest
+        void link(CancelWaiter* waiter) {
+            CancelWaiter** next = &head;
+            CancelWaiter* prev = nullptr;
+            for (; *next; next = &(*next)->next) {
+                prev = *next;
+            }
+            waiter->prev = prev;
+            waiter->next = nullptr;
+            *next = waiter;
+        }
+
+        void unlink(CancelWaiter* waiter) {
+            (waiter->prev ? waiter->prev->next : head) = waiter->next;
+            if (waiter->next) {
+                waiter->next->prev = waiter->prev;
+            }
+        }
+    };
+
+    /**
+     * @brief Shared implementation of the blocking sends.
+     * @param waiter The cancellable wait of the operation, or nullptr.
+     * @param deadline When to give up waiting, or nullptr to wait forever.
+     */
+    template <typename U>
+    ChannelStatus send_impl(U&& value, CancelWaiter* waiter,
+                            const Deadline* deadline);
+
+    /**
+     * @brief Shared implementation of the non-blocking sends. The value is
+     * only copied or moved from if it was sent.
+     */
+    template <typename U>
+    ChannelStatus try_send_impl(U&& value);
+
+    /**
+     * @brief Shared implementation of the blocking receives.
+     * @param sink Called with the received value.
+     * @param waiter The cancellable wait of the operation, or nullptr.
+     * @param deadline When to give up waiting, or nullptr to wait forever.
+     */
+    template <typename Sink>
+    ChannelStatus receive_impl(Sink sink, CancelWaiter* waiter,
+                               const Deadline* deadline);
+
+    /**
+     * @brief Shared implementation of the non-blocking receives.
+     */
+    template <typename Sink>
+    ChannelStatus try_receive_impl(Sink sink);
+
+    /**
+     * @brief Wakes a cancelled operation so it can leave. Called by the
+     * cancellation callbacks; other waiters keep sleeping.
+     */
+    void wake_for_cancel(CancelWaiter& waiter) {
+        std::unique_lock<std::mutex> lock(mtx);
+        waiter.cv.notify_one();
+    }
+
+    using Storage = std::conditional_t<
+        Policy::ring_storage,
+        detail::RingBuffer<T, Policy::static_capacity>,
+        detail::GrowableBuffer<T>>;
+
+    static Storage make_storage(
+        [[maybe_unused]] size_t cap,
+        [[maybe_unused]] const StorageOptions& options,
+        [[maybe_unused]] std::pmr::memory_resource* resource) {
+        if constexpr (Policy::static_capacity > 0) {
+            return Storage();
+        } else if constexpr (Policy::ring_storage) {
+            if (cap == 0) {
+                throw std::invalid_argument(
+                    "A ring channel needs a capacity greater than 0");
+            }
+            return Storage(cap, options, resource);
+        } else {
+            return Storage(resource);
+        }
+    }
+
+    /**
+     * @brief Lets the ring apply NumaPlacement::consumer_local. Called at the
+     * start of every receive.
+     */
+    void adopt_consumer_node() {
+        if constexpr (Policy::ring_storage) {
+            queue.adopt_consumer_node();
+        }
+    }
+
+    /**
+     * @brief Checks if sends must wait for a receiver.
+     */
+    bool is_rendezvous() const {
+        if constexpr (std::is_same_v<typename Policy::storage,
+                                     channel_policy::rendezvous>) {
+            return true;
+        } else if constexpr (std::is_same_v<typename Policy::storage,
+                                            channel_policy::dynamic>) {
+            return capacity == 0;
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Checks if a buffered channel has no free slot. Must be called
+     * with mtx held unless the channel is lock-free.
+     */
+    bool is_full() const {
+        if constexpr (Policy::fifo_senders) {
+            return free_space() == 0;  // Reserved slots count as taken
+        } else {
+            return buffer_full();
+        }
+    }
+
+    /**
+     * @brief Checks if every slot of a buffered channel holds a value,
+     * ignoring reserved slots. Safe without mtx: a true answer held when it
+     * was read, so try operations can fail on it without the lock.
+     */
+    bool buffer_full() const {
+        if constexpr (Policy::ring_storage) {
+            return queue.full();
+        } else if constexpr (std::is_same_v<typename Policy::storage,
+                                            channel_policy::unbounded>) {
+            return false;
+        } else {
+            return queue.size() >= capacity;
+        }
+    }
+
+    /**
+     * @brief Returns how many values fit in the buffer right now. Must be
+     * called with mtx held unless the channel is lock-free, in which case it
+     * is exact only for the producer.
+     */
+    size_t free_space() const {
+        if constexpr (Policy::ring_storage) {
+            return queue.capacity() - queue.size() - reservedSlots;
+        } else if constexpr (std::is_same_v<typename Policy::storage,
+                                            channel_policy::unbounded>) {
+            return std::numeric_limits<size_t>::max();
+        } else {
+            return capacity - std::min(queue.size() + reservedSlots, capacity);
+        }
+    }
+
+    // Only unbuffered channels pair senders and receivers by elimination
+    static constexpr bool kMayRendezvous =
+        std::is_same_v<typename Policy::storage, channel_policy::rendezvous> ||
+        std::is_same_v<typename Policy::storage, channel_policy::dynamic>;
+    static constexpr size_t kEliminationSlots = 4;
+    // Backoff steps a sender waits for a receiver before using the queue
+    static constexpr unsigned kEliminationSpins = 64;
+
+    /**
+     * @brief A value offered in the elimination array. Lives on the
+     * sender's stack. copy_from is only used when T cannot throw while
+     * copied; other values are copied by the sender and offered to move.
+     */
+    struct EliminationOffer {
+        enum State : uint8_t { waiting, taken, rejected };
+        const T* copy_from;
+        T* move_from;
+        std::atomic<uint8_t> state{waiting};
+    };
+
+    struct alignas(64) EliminationSlot {
+        std::atomic<EliminationOffer*> offer{nullptr};
+    };
+    struct NoElimination {};
+
+    /**
+     * @brief Unbuffered channels: offers the value in the elimination array
+     * and waits briefly for a receiver to take it. Must be called without
+     * mtx held.
+     * @return true if a receiver took the value, false if the sender must
+     * fall back to the queue.
+     */
+    template <typename U, typename Cancelled>
+    bool offer_for_elimination(U&& value, Cancelled cancelled);
+
+    /**
+     * @brief Unbuffered channels: takes a value offered in the elimination
+     * array, if any, and passes it to sink. Must be called without mtx
+     * held.
+     * @return true if a value was taken.
+     */
+    template <typename Sink>
+    bool take_eliminated(Sink& sink);
+
+    /**
+     * @brief A sender blocked on a full channel with channel_policy::fifo.
+     * Lives on the sender's stack while it is queued. A cancellable sender
+     * sleeps on the condition variable of its CancelWaiter.
+     */
+    struct SendWaiter {
+        explicit SendWaiter(CancelWaiter* waiter)
+            : cv(waiter ? waiter->cv : own) {}
+
+        std::condition_variable own;
+        std::condition_variable& cv;
+        SendWaiter* next = nullptr;
+        bool granted = false;  // A slot was reserved for this sender
+    };
+
+    /**
+     * @brief Waits until a buffered channel has a slot for the caller, the
+     * channel is closed, the caller is cancelled or the deadline passes.
+     * Must be called with mtx held. With channel_policy::fifo, the caller
+     * queues behind the senders already waiting and is handed its slot.
+     * @param waiter The cancellable wait of the caller, or nullptr.
+     * @return Whether a slot is available to the caller.
+     */
+    template <typename Cancelled>
+    bool wait_for_slot(std::unique_lock<std::mutex>& lock, Cancelled cancelled,
+                       CancelWaiter* waiter, const Deadline* deadline);
+
+    /**
+     * @brief Lets waiting senders know that values were taken out. Must be
+     * called with mtx held.
+     * @param freed The number of values taken out.
+     */
+    void notify_senders(size_t freed);
+
+    /**
+     * @brief channel_policy::fifo: reserves free slots for the oldest queued
+     * senders and wakes them. Must be called with mtx held.
+     */
+    void grant_slots();
+
+    /**
+     * @brief channel_policy::fifo: wakes every queued sender, so closing is
+     * noticed. Must be called with mtx held.
+     */
+    void notify_send_waiters();
+
+    /**
+     * @brief Waits on one side of the channel: on the side's condition
+     * variable, or, for a cancellable operation, linked into the side's list
+     * on its own. Must be called with mtx held.
+     * @param waiter The cancellable wait of the caller, or nullptr.
+     * @return The value of pred() when the wait ended.
+     */
+    template <typename Predicate>
+    bool wait(std::unique_lock<std::mutex>& lock, WaitList& side,
+              CancelWaiter* waiter, Predicate pred,
+              const Deadline* deadline = nullptr) {
+        if (!waiter) {
+            return wait(lock, side.cv, pred, deadline);
+        }
+        side.link(waiter);
+        bool ready = wait(lock, waiter->cv, pred, deadline);
+        side.unlink(waiter);
+        return ready;
+    }
+
+    /**
+     * @brief Waits on a condition variable according to the wait strategy.
+     * Must be called with mtx held.
+     * @param deadline When to give up, or nullptr to wait until pred() holds.
+     * @return The value of pred() when the wait ended.
+     */
+    template <typename Predicate>
+    bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& cv,
+              Predicate pred, const Deadline* deadline = nullptr) {
+        if constexpr (Policy::adaptive) {
+            // Under contention the state tends to change within a few
+            // microseconds, sooner than a sleep/wake round trip
+            if (contention.is_contended()) {
+                detail::Backoff backoff;
+                for (unsigned i = 0; i < kAdaptiveSpins && !pred(); ++i) {
+                    lock.unlock();
+                    backoff.pause();
+                    lock.lock();
+                }
+            }
+        }
+        if constexpr (Policy::blocking) {
+            if (deadline) {
+                return cv.wait_until(lock, *deadline, pred);
+            }
+            cv.wait(lock, pred);
+            return true;
+        } else if constexpr (Policy::polling) {
+            detail::Poller poller;
+            while (!pred()) {
+                if (deadline && Clock::now() >= *deadline) {
+                    return false;
+                }
+                lock.unlock();
+                poller.wait();
+                lock.lock();
+            }
+            return true;
+        } else {
+            detail::Backoff backoff;
+            while (!pred()) {
+                if (deadline && Clock::now() >= *deadline) {
+                    return false;
+                }
+                lock.unlock();
+                backoff.pause();
+                lock.lock();
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Locks mtx for a data operation. With the adaptive wait strategy
+     * this also samples contention, and spins on the lock for a while before
+     * blocking while the channel is contended.
+     */
+    std::unique_lock<std::mutex> lock_channel() {
+        if constexpr (Policy::adaptive) {
+            std::unique_lock<std::mutex> lock(mtx, std::try_to_lock);
+            contention.record(!lock.owns_lock());
+            if (lock.owns_lock()) {
+                return lock;
+            }
+            if (contention.is_contended()) {
+                detail::Backoff backoff;
+                for (unsigned i = 0; i < kAdaptiveSpins; ++i) {
+                    backoff.pause();
+                    if (lock.try_lock()) {
+                        return lock;
+                    }
+                }
+            }
+            lock.lock();
+            return lock;
+        } else {
+            return std::unique_lock<std::mutex>(mtx);
+        }
+    }
+
+    // Spin steps before blocking while an adaptive channel is contended:
+    // the whole exponential backoff, then a couple of yields
+    static constexpr unsigned kAdaptiveSpins = 8;
+
+    /**
+     * @brief Notifies all registered selectors. Must be called with mtx
+     * held.
+     */
+    void notify_selectors();
+
+    /**
+     * @brief Wakes a parked peer of the lock-free ring after the ring
+     * changed, and notifies registered selectors after a push.
+     * @param waiting The number of parked peers.
+     * @param side The side the peer parks on.
+     * @param pushed Whether the ring changed because of a push.
+     * @param count How many elements were pushed or popped.
+     */
+    void wake_peer(std::atomic<size_t>& waiting, WaitList& side, bool pushed,
+                   size_t count = 1);
+
+    /**
+     * @brief Lock-free ring: parks the calling thread until pred() holds or
+     * the deadline passes.
+     * @param waiting The number of parked threads of the calling side.
+     * @param waiter The cancellable wait of the caller, or nullptr.
+     * @return The value of pred() when the wait ended.
+     */
+    template <typename Predicate>
+    bool park(std::atomic<size_t>& waiting, WaitList& side,
+              CancelWaiter* waiter, Predicate pred,
+              const Deadline* deadline = nullptr);
+
+    /**
+     * @brief Lock-free ring: serializes the producers while more than one
+     * Sender handle exists, or when the channel is used without handles.
+     * A declared single side is never locked.
+     */
+    std::unique_lock<std::mutex> producer_lock() {
+        if constexpr (Policy::counted_producers) {
+            if (producerHandles.load(std::memory_order_acquire) != 1) {
+                return std::unique_lock<std::mutex>(producerMtx);
+            }
+        }
+        return std::unique_lock<std::mutex>();
+    }
+
+    /**
+     * @brief Lock-free ring: the consumer-side counterpart of
+     * producer_lock().
+     */
+    std::unique_lock<std::mutex> consumer_lock() {
+        if constexpr (Policy::counted_consumers) {
+            if (consumerHandles.load(std::memory_order_acquire) != 1) {
+                return std::unique_lock<std::mutex>(consumerMtx);
+            }
+        }
+        return std::unique_lock<std::mutex>();
+    }
+
     /**
      * @brief Registers a selector with the channel.
      *
@@ -177,15 +964,160 @@ class Channel {
      */
     void unregister_selector(Selector* selector);
 
-    std::queue<T> queue;
-    mutable std::mutex mtx;
-    std::condition_variable cv_send, cv_recv;
-    bool closed = false;
+    Storage queue;
+    std::mutex mtx;
+    WaitList cv_send, cv_recv;
+    std::atomic<bool> closed{false};
     size_t capacity;
-    size_t waitingReceivers = 0;
+    // Atomic so senders can check it without mtx before offering a value
+    // for elimination
+    std::atomic<size_t> waitingReceivers{0};
+
+    // channel_policy::fifo only: the queue of blocked senders, oldest first,
+    // and the slots handed to senders that have not filled them yet.
+    SendWaiter* sendHead = nullptr;
+    SendWaiter* sendTail = nullptr;
+    size_t reservedSlots = 0;
+
+    // Lock-free ring only: the number of threads of each side parked on its
+    // condition variable, and the number of registered selectors.
+    std::atomic<size_t> sendersWaiting{0};
+    std::atomic<size_t> receiversWaiting{0};
+    std::atomic<size_t> selectorCount{0};
+
+    // Counted sides only: the live Sender/Receiver handles, and the locks
+    // taken while a side is shared.
+    std::atomic<size_t> producerHandles{0};
+    std::atomic<size_t> consumerHandles{0};
+    std::mutex producerMtx;
+    std::mutex consumerMtx;
+
+    // Adaptive wait strategy only: how contended mtx has been recently
+    detail::ContentionMonitor contention;
+
+    // Unbuffered channels only: the elimination array
+    std::conditional_t<kMayRendezvous,
+                       std::array<EliminationSlot, kEliminationSlots>,
+                       NoElimination>
+        elimination;
+
+    // Debug-build detection of concurrent use of a side declared single
+    detail::SingleUseChecker<Policy::single_producer> producerCheck;
+    detail::SingleUseChecker<Policy::single_consumer> consumerCheck;
 
     friend class Selector;
-    std::vector<Selector*> selectors;
+    template <typename, typename>
+    friend class Sender;
+    template <typename, typename>
+    friend class Receiver;
+    std::pmr::vector<Selector*> selectors;
+};
+
+/**
+ * @brief An input iterator over the values received from a channel, one at
+ * a time.
+ *
+ * Dereferencing gives the current value, which may be moved from;
+ * incrementing receives the next one.
+ */
+template <typename T, typename Policy>
+class Channel<T, Policy>::ReceiveIterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    explicit ReceiveIterator(Channel& channel)
+        : channel(&channel), current(channel.receive()) {}
+
+    T& operator*() { return *current; }
+    T* operator->() { return &*current; }
+    ReceiveIterator& operator++() {
+        current = channel->receive();
+        return *this;
+    }
+
+    bool operator==(ReceiveSentinel) const { return !current; }
+    bool operator!=(ReceiveSentinel) const { return current.has_value(); }
+
+   private:
+    Channel* channel;
+    std::optional<T> current;  // Empty at the end
+};
+
+/**
+ * @brief An input iterator over the values received from a channel in
+ * batches, as used by Channel::drain().
+ *
+ * Holds the batch taken from the channel by the last receive. Dereferencing
+ * gives the current value, which may be moved from; incrementing moves to the
+ * next one, receiving the next batch when this one is used up. If T is not
+ * default constructible (or is bool), values are received one at a time.
+ */
+template <typename T, typename Policy>
+class Channel<T, Policy>::DrainIterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    DrainIterator(Channel& channel, size_t batch);
+
+    T& operator*() {
+        if constexpr (batched) {
+            return buffer[position];
+        } else {
+            return *buffer;
+        }
+    }
+    T* operator->() { return &**this; }
+    DrainIterator& operator++();
+
+    bool operator==(ReceiveSentinel) const { return count == 0; }
+    bool operator!=(ReceiveSentinel) const { return count != 0; }
+
+   private:
+    /**
+     * @brief Receives the next batch, blocking until a value arrives or the
+     * channel is closed and empty.
+     */
+    void fill();
+
+    // std::vector<bool> cannot be received into
+    static constexpr bool batched =
+        std::is_default_constructible_v<T> && !std::is_same_v<T, bool>;
+    // The batch; a single value when it cannot be batched
+    using Buffer =
+        std::conditional_t<batched, std::pmr::vector<T>, std::optional<T>>;
+
+    static Buffer make_buffer(Channel& channel, size_t batch);
+
+    Channel* channel;
+    Buffer buffer;
+    size_t position = 0;
+    size_t count = 0;  // Values in the batch; 0 at the end
+};
+
+/**
+ * @brief A range over the values received from a channel, as returned by
+ * Channel::drain().
+ */
+template <typename T, typename Policy>
+class Channel<T, Policy>::DrainRange {
+   public:
+    DrainRange(Channel& channel, size_t batch)
+        : channel(&channel), batch(batch) {}
+
+    DrainIterator begin() { return DrainIterator(*channel, batch); }
+    ReceiveSentinel end() { return {}; }
+
+   private:
+    Channel* channel;
+    size_t batch;
 };
 
 /**
@@ -198,7 +1130,14 @@ class Channel {
  */
 class Selector {
    public:
-    Selector() : stop_flag_(false) {}
+    /**
+     * @brief Constructs a Selector object.
+     * @param resource Supplies the list of channels and the state of their
+     * callbacks. Must outlive the selector.
+     */
+    explicit Selector(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : channels(resource), stop_flag_(false) {}
     // Disable copying and moving
     Selector(const Selector&) = delete;
     Selector& operator=(const Selector&) = delete;
@@ -213,13 +1152,27 @@ class Selector {
      *
      * @tparam T the type of the channel.
      * @param ch The channel to add.
-     * @param callback The callback function to call when a message is received.
+     * @param callback The callback function to call when a message is
+     * received. Any callable taking a T; it is stored in memory from the
+     * selector's resource.
      *
      * Use Case: Add a channel to the selector and specify a callback function
      * to be called when a message is received.
      */
-    template <typename T>
-    void add_receive(Channel<T>& ch, std::function<void(T)> callback);
+    template <typename T, typename Policy, typename Callback>
+    void add_receive(Channel<T, Policy>& ch, Callback callback);
+
+    /**
+     * @brief Adds a signal channel to the selector.
+     *
+     * @param ch The signal channel to add.
+     * @param callback Any callable taking no arguments, called once per
+     * signal taken from the channel.
+     *
+     * Use Case: Wake a select loop without sending dummy values.
+     */
+    template <typename Policy, typename Callback>
+    void add_receive(Channel<void, Policy>& ch, Callback callback);
 
     /**
      * @brief Continuously processes events on registered channels until
@@ -246,6 +1199,16 @@ class Selector {
      */
     void select();
 
+    /**
+     * @brief Like select(), but returns early when the token is cancelled.
+     * @param token The token that cancels the operation.
+     * @return false if select() returned because the token was cancelled.
+     *
+     * Use Case: Stop one select loop without stopping the selector for
+     * other users or closing any channel.
+     */
+    bool select(const CancellationToken& token);
+
     /**
      * @brief Stops the select operation and unblocks the select() method.
      *
@@ -253,7 +1216,7 @@ class Selector {
      * Example: selector.stop();
      */
     void stop() {
-        stop_flag_.test_and_set(std::memory_order_relaxed);
+        stop_flag_.store(true, std::memory_order_relaxed);
         notify();
     }
 
@@ -265,9 +1228,24 @@ class Selector {
      * @note This function is meant for internal use and should not be called
      * directly (unless you know what you're doing).
      */
-    void notify() { cv.notify_all(); }
+    void notify() {
+        {
+            // Taken so a notification can't slip in between the select loop
+            // checking `notified_` and going to sleep.
+            std::unique_lock<std::mutex> lock(notify_mtx_);
+            notified_ = true;
+        }
+        cv.notify_all();
+    }
 
    private:
+    /**
+     * @brief Shared implementation of select().
+     * @param token The token that cancels the operation, or nullptr.
+     * @return false if the operation was cancelled.
+     */
+    bool select_impl(const CancellationToken* token);
+
     /**
      * @brief Checks if a stop has been requested.
      *
@@ -275,15 +1253,69 @@ class Selector {
      * @return false
      */
     bool stop_requested() const {
-        return stop_flag_.test(std::memory_order_relaxed);
+        return stop_flag_.load(std::memory_order_relaxed);
     }
 
-    std::vector<std::function<bool()>> channels;
-    std::atomic_flag stop_flag_;
-    std::mutex mtx;
+    /**
+     * @brief A registered channel: a poll function returning true once the
+     * channel is closed and drained, with its state allocated from the
+     * selector's memory resource.
+     */
+    class Entry {
+       public:
+        template <typename Fn>
+        Entry(Fn fn, std::pmr::memory_resource* resource)
+            : resource(resource),
+              state(new (resource->allocate(sizeof(Fn), alignof(Fn)))
+                        Fn(std::move(fn))),
+              poll([](void* state) { return (*static_cast<Fn*>(state))(); }),
+              destroy([](void* state, std::pmr::memory_resource* resource) {
+                  static_cast<Fn*>(state)->~Fn();
+                  resource->deallocate(state, sizeof(Fn), alignof(Fn));
+              }) {}
+
+        Entry(Entry&& other) noexcept
+            : resource(other.resource),
+              state(std::exchange(other.state, nullptr)),
+              poll(other.poll),
+              destroy(other.destroy) {}
+
+        Entry& operator=(Entry&& other) noexcept {
+            std::swap(resource, other.resource);
+            std::swap(state, other.state);
+            std::swap(poll, other.poll);
+            std::swap(destroy, other.destroy);
+            return *this;
+        }
+
+        ~Entry() {
+            if (state) {
+                destroy(state, resource);
+            }
+        }
+
+        bool operator()() { return poll(state); }
+
+       private:
+        std::pmr::memory_resource* resource;
+        void* state;
+        bool (*poll)(void*);
+        void (*destroy)(void*, std::pmr::memory_resource*);
+    };
+
+    std::pmr::vector<Entry> channels;
+    std::atomic<bool> stop_flag_;
+    std::mutex mtx;  // Protects channels
+    // Leaf lock for the wakeup handshake; channels notify while holding
+    // their own lock, so this must never be held while calling into them.
+    std::mutex notify_mtx_;
+    bool notified_ = false;
     std::condition_variable cv;
 };
 
 #include "channel.cc"
 
+// Channel<void>, the payload-free signal channel
+#include "signal_channel.h"
+
 #endif  // CHANNEL_H
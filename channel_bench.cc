@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "batching_sender.h"
+#include "channel.h"
+#include "combining_channel.h"
+#include "numa_channel.h"
+
+// Compares the growable storages for elements of different sizes, and the
+// end-to-end cost of a buffered Channel, which picks one of them at compile
+// time, and of several producers sending one value at a time or through a
+// BatchingSender, and the tail latency of blocked senders with barging
+// and FIFO fairness, and a mutex channel against the flat-combining one as
+// the thread count grows, and a SignalChannel against a Channel<bool> used
+// as a wakeup; then measures the one-way handoff latency of the SPSC ring
+// under each wait strategy, and on NUMA machines the cost of a ring placed
+// on a remote node. Build with `make bench`.
+
+template <size_t Size>
+struct Blob {
+    char bytes[Size];
+};
+
+constexpr int kOperations = 1 << 20;
+constexpr int kBurst = 256;  // Elements queued before draining
+
+template <typename Fn>
+double ns_per_op(Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           kOperations;
+}
+
+template <typename Buffer, typename T>
+double bench_storage() {
+    Buffer buffer;
+    T value{};
+    return ns_per_op([&] {
+        for (int i = 0; i < kOperations; i += kBurst) {
+            for (int j = 0; j < kBurst; ++j) {
+                value.bytes[0] = static_cast<char>(j);
+                buffer.push(value);
+            }
+            for (int j = 0; j < kBurst; ++j) {
+                value = buffer.pop();
+            }
+        }
+    });
+}
+
+template <typename T>
+double bench_channel() {
+    Channel<T> ch(kBurst);
+    return ns_per_op([&] {
+        std::thread producer([&] {
+            T value{};
+            for (int i = 0; i < kOperations; ++i) {
+                ch.send(value);
+            }
+        });
+        for (int i = 0; i < kOperations; ++i) {
+            ch.receive();
+        }
+        producer.join();
+    });
+}
+
+template <size_t Size>
+void run() {
+    using T = Blob<Size>;
+    double queue = bench_storage<detail::QueueBuffer<T>, T>();
+    double slab = bench_storage<detail::SlabBuffer<T>, T>();
+    double channel = bench_channel<T>();
+    bool uses_slab =
+        std::is_same_v<detail::GrowableBuffer<T>, detail::SlabBuffer<T>>;
+    printf("%6zu B  queue %7.1f ns  slab %7.1f ns  channel (%s) %7.1f ns\n",
+           Size, queue, slab, uses_slab ? "slab " : "queue", channel);
+}
+
+// Several producers feeding one consumer, each sending one value at a time
+// or batching with a BatchingSender of the given size (0 for none)
+double bench_producers(int producers, size_t batch_size) {
+    Channel<int> ch(kBurst);
+    return ns_per_op([&] {
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&] {
+                int count = kOperations / producers;
+                if (batch_size == 0) {
+                    for (int i = 0; i < count; ++i) {
+                        ch.send(i);
+                    }
+                    return;
+                }
+                BatchingSender<int> batch(ch, batch_size);
+                for (int i = 0; i < count; ++i) {
+                    batch.send(i);
+                }
+            });
+        }
+        int block[64];
+        for (int received = 0; received < kOperations;) {
+            received += static_cast<int>(ch.receive_batch(block, 64));
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    });
+}
+
+// Eight producers keep a small channel full; returns the p99.99 time a
+// send spent blocked, in microseconds
+template <typename Fairness>
+double bench_send_tail() {
+    constexpr int kProducers = 8;
+    constexpr int kPerProducer = 20000;
+    Channel<int, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                               channel_policy::dynamic, channel_policy::block,
+                               Fairness>>
+        ch(16);
+    std::vector<std::vector<double>> waits(kProducers);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&ch, &samples = waits[p]] {
+            samples.reserve(kPerProducer);
+            for (int i = 0; i < kPerProducer; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                ch.send(i);
+                samples.push_back(std::chrono::duration<double, std::micro>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count());
+            }
+        });
+    }
+    for (int i = 0; i < kProducers * kPerProducer; ++i) {
+        ch.receive();
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    std::vector<double> all;
+    for (auto& samples : waits) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    auto tail = all.begin() + static_cast<long>(all.size() * 9999 / 10000);
+    std::nth_element(all.begin(), tail, all.end());
+    return *tail;
+}
+
+// Half the threads send, half receive, all on one channel
+template <typename Ch>
+double bench_contended(int threads) {
+    Ch ch(1024);
+    int pairs = threads / 2;
+    int per_thread = kOperations / pairs;
+    return ns_per_op([&] {
+        std::vector<std::thread> workers;
+        for (int i = 0; i < pairs; ++i) {
+            workers.emplace_back([&ch, per_thread] {
+                for (int j = 0; j < per_thread; ++j) {
+                    ch.send(j);
+                }
+            });
+            workers.emplace_back([&ch, per_thread] {
+                for (int j = 0; j < per_thread; ++j) {
+                    ch.receive();
+                }
+            });
+        }
+        for (auto& t : workers) {
+            t.join();
+        }
+    });
+}
+
+// Signals queued in bursts and taken back without blocking, by the payload-
+// free channel and by a channel of dummy values
+double bench_signal_channel() {
+    SignalChannel signals;
+    return ns_per_op([&] {
+        for (int i = 0; i < kOperations; i += kBurst) {
+            for (int j = 0; j < kBurst; ++j) {
+                signals.notify();
+            }
+            for (int j = 0; j < kBurst; ++j) {
+                signals.try_wait();
+            }
+        }
+    });
+}
+
+double bench_bool_channel() {
+    Channel<bool> signals(kBurst);
+    return ns_per_op([&] {
+        for (int i = 0; i < kOperations; i += kBurst) {
+            for (int j = 0; j < kBurst; ++j) {
+                signals.send(true);
+            }
+            for (int j = 0; j < kBurst; ++j) {
+                signals.try_receive();
+            }
+        }
+    });
+}
+
+// Ping-pong between two threads over a pair of SPSC channels; half a round
+// trip is the one-way handoff latency
+template <typename Wait>
+double bench_handoff(int rounds) {
+    SpscChannel<int, Wait> ping(1);
+    SpscChannel<int, Wait> pong(1);
+    std::thread echo([&] {
+        for (int i = 0; i < rounds; ++i) {
+            pong.send(*ping.receive());
+        }
+    });
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        ping.send(i);
+        pong.receive();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    echo.join();
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           (2.0 * rounds);
+}
+
+// Pins the calling thread to the CPUs of a NUMA node, as listed in sysfs
+// (e.g. "0-15,32-47")
+bool run_on_node([[maybe_unused]] int node) {
+#if defined(__linux__)
+    std::ifstream file("/sys/devices/system/node/node" +
+                       std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!std::getline(file, list)) {
+        return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    std::stringstream ranges(list);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        int first = 0;
+        int last = 0;
+        if (sscanf(range.c_str(), "%d-%d", &first, &last) < 2) {
+            last = first;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+    return false;
+#endif
+}
+
+// Streams kOperations cache-line sized values from a producer on one node
+// to a consumer on another
+template <typename Send, typename Receive>
+double bench_nodes(int producer_node, int consumer_node, Send send,
+                   Receive receive) {
+    return ns_per_op([&] {
+        std::thread producer([&] {
+            run_on_node(producer_node);
+            for (int i = 0; i < kOperations; ++i) {
+                send();
+            }
+        });
+        std::thread consumer([&] {
+            run_on_node(consumer_node);
+            for (int i = 0; i < kOperations; ++i) {
+                receive();
+            }
+        });
+        producer.join();
+        consumer.join();
+    });
+}
+
+void bench_numa(int local, int remote) {
+    using T = Blob<64>;
+    auto ring = [](int node) {
+        return std::make_unique<SpscChannel<T>>(kBurst,
+                                                StorageOptions::on_node(node));
+    };
+    printf("\nring placement, producer and consumer on node %d\n", local);
+    for (int node : {local, remote}) {
+        auto ch = ring(node);
+        double ns = bench_nodes(
+            local, local, [&] { ch->send(T{}); }, [&] { ch->receive(); });
+        printf("  slots on node %d %7.1f ns\n", node, ns);
+    }
+
+    printf("\nproducer on node %d, consumer on node %d\n", remote, local);
+    for (auto placement :
+         {NumaPlacement::first_touch, NumaPlacement::consumer_local}) {
+        StorageOptions options;
+        options.placement = placement;
+        SpscChannel<T> ch(kBurst, options);
+        double ns = bench_nodes(
+            remote, local, [&] { ch.send(T{}); }, [&] { ch.receive(); });
+        printf("  %-14s %7.1f ns\n",
+               placement == NumaPlacement::first_touch ? "first touch"
+                                                       : "consumer local",
+               ns);
+    }
+
+    // One producer and one consumer per node: a single shared ring makes
+    // half of the traffic cross nodes, the sharded channel keeps it local
+    printf("\nproducer and consumer on each of nodes %d and %d\n", local,
+           remote);
+    using Shared = NumaChannel<T>::Shard;
+    Shared shared(2 * kBurst, StorageOptions::on_node(local));
+    NumaChannel<T> sharded(kBurst, {local, remote});
+    auto both = [&](auto send, auto receive) {
+        return ns_per_op([&] {
+            std::vector<std::thread> threads;
+            for (int node : {local, remote}) {
+                threads.emplace_back([&, node] {
+                    run_on_node(node);
+                    for (int i = 0; i < kOperations / 2; ++i) {
+                        send();
+                    }
+                });
+                threads.emplace_back([&, node] {
+                    run_on_node(node);
+                    for (int i = 0; i < kOperations / 2; ++i) {
+                        receive();
+                    }
+                });
+            }
+            for (auto& t : threads) {
+                t.join();
+            }
+        });
+    };
+    printf("  shared ring    %7.1f ns\n",
+           both([&] { shared.send(T{}); }, [&] { shared.receive(); }));
+    printf("  NumaChannel    %7.1f ns\n",
+           both([&] { sharded.send(T{}); }, [&] { sharded.receive(); }));
+}
+
+int main() {
+    printf("ns per element, bursts of %d\n", kBurst);
+    run<8>();
+    run<64>();
+    run<128>();
+    run<256>();
+    run<1024>();
+    run<4096>();
+
+    printf("\n4 producers, 1 consumer, int values\n");
+    printf("  send               %7.1f ns\n", bench_producers(4, 0));
+    printf("  BatchingSender(32) %7.1f ns\n", bench_producers(4, 32));
+
+    printf("\np99.99 blocked send, 8 producers, capacity 16\n");
+    printf("  barging %9.1f us\n",
+           bench_send_tail<channel_policy::barging>());
+    printf("  fifo    %9.1f us\n", bench_send_tail<channel_policy::fifo>());
+
+    printf("\nthreads hammering one channel, capacity 1024\n");
+    for (int threads : {4, 16, 64}) {
+        printf("  %2d threads  mutex %7.1f ns  combining %7.1f ns\n", threads,
+               bench_contended<Channel<int>>(threads),
+               bench_contended<CombiningChannel<int>>(threads));
+    }
+
+    printf("\nwakeup signals, bursts of %d\n", kBurst);
+    printf("  Channel<bool> %7.1f ns\n", bench_bool_channel());
+    printf("  SignalChannel %7.1f ns\n", bench_signal_channel());
+
+    // Spinning and polling need a core per thread to mean anything
+    if (std::thread::hardware_concurrency() < 2) {
+        printf("\nSkipping handoff latency: needs at least 2 cores\n");
+    } else {
+        constexpr int kRounds = 100000;
+        printf("\none-way handoff latency (WAITPKG %s)\n",
+               detail::cpu_has_waitpkg() ? "on" : "off");
+        printf("  block %7.1f ns\n",
+               bench_handoff<channel_policy::block>(kRounds));
+        printf("  spin  %7.1f ns\n",
+               bench_handoff<channel_policy::spin>(kRounds));
+        printf("  poll  %7.1f ns\n",
+               bench_handoff<channel_policy::poll>(kRounds));
+    }
+
+    const auto& nodes = detail::numa_nodes();
+    if (nodes.size() < 2) {
+        printf("\nSkipping NUMA placement: needs at least 2 nodes\n");
+        return 0;
+    }
+    bench_numa(nodes[0], nodes[1]);
+    return 0;
+}
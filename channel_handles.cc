@@ -0,0 +1,60 @@
+#include "channel_handles.h"
+
+template <typename T, typename Policy>
+std::pair<Sender<T, Policy>, Receiver<T, Policy>> make_channel(size_t cap) {
+    auto channel = std::make_shared<Channel<T, Policy>>(cap);
+    return {Sender<T, Policy>(channel), Receiver<T, Policy>(channel)};
+}
+
+template <typename T, typename Policy>
+Sender<T, Policy>::Sender(std::shared_ptr<Channel<T, Policy>> channel)
+    : channel(std::move(channel)) {
+    this->channel->producerHandles.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T, typename Policy>
+Sender<T, Policy>::Sender(const Sender& other) : channel(other.channel) {
+    // Only the thread holding the sole Sender can make the count go from 1
+    // to 2, so no send is in flight on the unlocked path while it changes
+    if (channel) {
+        channel->producerHandles.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, typename Policy>
+void Sender<T, Policy>::reset() {
+    if (!channel) {
+        return;
+    }
+    // Publishes our sends to a remaining Sender that stops locking
+    if (channel->producerHandles.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+        channel->close();
+    }
+    channel.reset();
+}
+
+template <typename T, typename Policy>
+Receiver<T, Policy>::Receiver(std::shared_ptr<Channel<T, Policy>> channel)
+    : channel(std::move(channel)) {
+    this->channel->consumerHandles.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T, typename Policy>
+Receiver<T, Policy>::Receiver(const Receiver& other) : channel(other.channel) {
+    if (channel) {
+        channel->consumerHandles.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <typename T, typename Policy>
+void Receiver<T, Policy>::reset() {
+    if (!channel) {
+        return;
+    }
+    if (channel->consumerHandles.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+        channel->close();
+    }
+    channel.reset();
+}
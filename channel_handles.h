@@ -0,0 +1,205 @@
+#ifndef CHANNEL_HANDLES_H
+#define CHANNEL_HANDLES_H
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "channel.h"
+
+// Default policy for channels used through handles: a ring whose producer
+// and consumer sides switch between the lock-free and the locked algorithm
+// as handles are cloned and dropped.
+using HandleChannelPolicy =
+    ChannelPolicy<channel_policy::counted, channel_policy::counted,
+                  channel_policy::bounded_ring>;
+
+template <typename T, typename Policy = HandleChannelPolicy>
+class Sender;
+template <typename T, typename Policy = HandleChannelPolicy>
+class Receiver;
+
+/**
+ * @brief Creates a channel and returns its first Sender and Receiver.
+ * @param cap The capacity of the channel.
+ * @return The sending and the receiving handle.
+ * @throws std::invalid_argument if the policy uses a bounded ring and cap is
+ * 0.
+ *
+ * Use Case: Hand each thread only the side of the channel it uses, and let
+ * the channel close itself when the producers are done.
+ * Example: auto [tx, rx] = make_channel<int>(64);
+ *          std::thread producer([tx = std::move(tx)] { tx.send(1); });
+ *          while (auto value = rx.receive()) { ... }
+ */
+template <typename T, typename Policy = HandleChannelPolicy>
+std::pair<Sender<T, Policy>, Receiver<T, Policy>> make_channel(size_t cap);
+
+/**
+ * @brief A reference-counted handle to the sending side of a channel.
+ *
+ * Copying a Sender adds a producer; the channel is closed when the last
+ * Sender is destroyed or reset. With channel_policy::counted producers, the
+ * channel skips the producer lock while exactly one Sender exists.
+ *
+ * A handle is used by one thread at a time. Give each producer thread its own
+ * copy instead of sharing one by reference.
+ *
+ * @tparam T The type of the values.
+ * @tparam Policy The policy of the underlying channel.
+ */
+template <typename T, typename Policy>
+class Sender {
+   public:
+    Sender() = default;
+    Sender(const Sender& other);
+    Sender(Sender&& other) noexcept : channel(std::move(other.channel)) {}
+    Sender& operator=(Sender other) noexcept {
+        std::swap(channel, other.channel);
+        return *this;
+    }
+    ~Sender() { reset(); }
+
+    /**
+     * @brief Drops this handle, closing the channel if it was the last
+     * Sender. The handle is empty afterwards.
+     */
+    void reset();
+
+    /**
+     * @brief Checks if the handle refers to a channel.
+     */
+    explicit operator bool() const { return channel != nullptr; }
+
+    void send(const T& value) const { channel->send(value); }
+    void send(T&& value) const { channel->send(std::move(value)); }
+    bool try_send(const T& value) const { return channel->try_send(value); }
+    bool try_send(T&& value) const {
+        return channel->try_send(std::move(value));
+    }
+    ChannelStatus send_status(const T& value) const
+        noexcept(Channel<T, Policy>::nothrow_send) {
+        return channel->send_status(value);
+    }
+    ChannelStatus try_send_status(const T& value) const
+        noexcept(Channel<T, Policy>::nothrow_send) {
+        return channel->try_send_status(value);
+    }
+    template <typename Rep, typename Period>
+    ChannelStatus send_status_for(
+        const T& value, const std::chrono::duration<Rep, Period>& timeout) const
+        noexcept(Channel<T, Policy>::nothrow_send) {
+        return channel->send_status_for(value, timeout);
+    }
+    void send_batch(const T* values, size_t count) const {
+        channel->send_batch(values, count);
+    }
+    size_t try_send_batch(const T* values, size_t count) const {
+        return channel->try_send_batch(values, count);
+    }
+
+    bool is_closed() const { return channel->is_closed(); }
+
+    /**
+     * @brief Returns the number of live Sender handles of the channel.
+     */
+    size_t sender_count() const {
+        return channel->producerHandles.load(std::memory_order_acquire);
+    }
+
+   private:
+    friend std::pair<Sender, Receiver<T, Policy>> make_channel<T, Policy>(
+        size_t cap);
+    explicit Sender(std::shared_ptr<Channel<T, Policy>> channel);
+
+    std::shared_ptr<Channel<T, Policy>> channel;
+};
+
+/**
+ * @brief A reference-counted handle to the receiving side of a channel.
+ *
+ * Copying a Receiver adds a consumer; the channel is closed when the last
+ * Receiver is destroyed or reset, so senders stop instead of filling a
+ * channel nobody reads. With channel_policy::counted consumers, the channel
+ * skips the consumer lock while exactly one Receiver exists.
+ *
+ * @tparam T The type of the values.
+ * @tparam Policy The policy of the underlying channel.
+ */
+template <typename T, typename Policy>
+class Receiver {
+   public:
+    Receiver() = default;
+    Receiver(const Receiver& other);
+    Receiver(Receiver&& other) noexcept : channel(std::move(other.channel)) {}
+    Receiver& operator=(Receiver other) noexcept {
+        std::swap(channel, other.channel);
+        return *this;
+    }
+    ~Receiver() { reset(); }
+
+    /**
+     * @brief Drops this handle, closing the channel if it was the last
+     * Receiver. The handle is empty afterwards.
+     */
+    void reset();
+
+    /**
+     * @brief Checks if the handle refers to a channel.
+     */
+    explicit operator bool() const { return channel != nullptr; }
+
+    std::optional<T> receive() const { return channel->receive(); }
+    std::optional<T> try_receive() const { return channel->try_receive(); }
+    ChannelStatus receive_status(T& out) const
+        noexcept(Channel<T, Policy>::nothrow_receive) {
+        return channel->receive_status(out);
+    }
+    ChannelStatus try_receive_status(T& out) const
+        noexcept(Channel<T, Policy>::nothrow_receive) {
+        return channel->try_receive_status(out);
+    }
+    template <typename Rep, typename Period>
+    ChannelStatus receive_status_for(
+        T& out, const std::chrono::duration<Rep, Period>& timeout) const
+        noexcept(Channel<T, Policy>::nothrow_receive) {
+        return channel->receive_status_for(out, timeout);
+    }
+    size_t receive_batch(T* out, size_t max) const {
+        return channel->receive_batch(out, max);
+    }
+    size_t try_receive_batch(T* out, size_t max) const {
+        return channel->try_receive_batch(out, max);
+    }
+    typename Channel<T, Policy>::ReceiveIterator begin() const {
+        return channel->begin();
+    }
+    typename Channel<T, Policy>::ReceiveSentinel end() const { return {}; }
+    typename Channel<T, Policy>::DrainRange drain(
+        size_t batch = Channel<T, Policy>::kDrainBatch) const {
+        return channel->drain(batch);
+    }
+
+    bool is_closed() const { return channel->is_closed(); }
+    bool is_empty() const { return channel->is_empty(); }
+    size_t size() const { return channel->size(); }
+
+    /**
+     * @brief Returns the number of live Receiver handles of the channel.
+     */
+    size_t receiver_count() const {
+        return channel->consumerHandles.load(std::memory_order_acquire);
+    }
+
+   private:
+    friend std::pair<Sender<T, Policy>, Receiver> make_channel<T, Policy>(
+        size_t cap);
+    explicit Receiver(std::shared_ptr<Channel<T, Policy>> channel);
+
+    std::shared_ptr<Channel<T, Policy>> channel;
+};
+
+#include "channel_handles.cc"
+
+#endif  // CHANNEL_HANDLES_H
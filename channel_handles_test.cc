@@ -0,0 +1,171 @@
+#include "channel_handles.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+void test_close_on_last_sender() {
+    log("Testing close when the last sender is dropped");
+    auto [tx, rx] = make_channel<int>(4);
+    assert(tx.sender_count() == 1 && rx.receiver_count() == 1);
+
+    Sender<int> second = tx;
+    assert(tx.sender_count() == 2);
+    tx.send(1);
+    second.send(2);
+
+    tx.reset();
+    assert(!tx && !rx.is_closed());  // The second sender keeps it open
+    Sender<int> moved = std::move(second);
+    assert(!second && moved.sender_count() == 1);
+    moved.send(3);
+    moved.reset();
+    assert(rx.is_closed());
+
+    // Values sent before the close are still received
+    assert(*rx.receive() == 1 && *rx.receive() == 2 && *rx.receive() == 3);
+    assert(!rx.receive());
+    log("Close on last sender test completed");
+}
+
+void test_close_on_last_receiver() {
+    log("Testing close when the last receiver is dropped");
+    auto [tx, rx] = make_channel<int>(1);
+    tx.send(1);
+    // A sender blocked on a full channel is released when nobody can
+    // receive anymore
+    std::thread dropper([rx = std::move(rx)]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        rx.reset();
+    });
+    assert(tx.send_status(2) == ChannelStatus::closed);
+    dropper.join();
+    try {
+        tx.send(3);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::runtime_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    log("Close on last receiver test completed");
+}
+
+void test_spsc_to_mpmc() {
+    log("Testing transitions between single and shared sides");
+    constexpr int kPerProducer = 20000;
+    auto [tx, rx] = make_channel<int>(16);
+
+    // Starts with one sender and one receiver, then clones both while
+    // values are in flight
+    std::vector<long long> sums(2, 0);
+    std::vector<int> counts(2, 0);
+    Receiver<int> rx2 = rx;
+    std::thread consumer([&sums, &counts, rx2 = std::move(rx2)] {
+        std::vector<int> block(7);
+        while (size_t n = rx2.receive_batch(block.data(), block.size())) {
+            for (size_t i = 0; i < n; ++i) {
+                sums[1] += block[i];
+            }
+            counts[1] += static_cast<int>(n);
+        }
+    });
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; ++p) {
+        producers.emplace_back([tx = tx, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                tx.send(p * kPerProducer + i);
+            }
+        });
+    }
+    std::thread last([tx = std::move(tx)] {
+        for (int i = 0; i < kPerProducer; ++i) {
+            tx.send(3 * kPerProducer + i);
+        }
+    });
+    while (auto value = rx.receive()) {
+        sums[0] += *value;
+        counts[0]++;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    last.join();
+    consumer.join();
+
+    long long total = 4LL * kPerProducer;
+    assert(counts[0] + counts[1] == total && "Lost values");
+    assert(sums[0] + sums[1] == total * (total - 1) / 2 &&
+           "Corrupted values");
+    log("Transition test completed");
+}
+
+void test_single_handles_in_order() {
+    log("Testing ordered transfer with a single sender and receiver");
+    auto [tx, rx] = make_channel<std::string>(8);
+    std::thread producer([tx = std::move(tx)] {
+        for (int i = 0; i < 10000; ++i) {
+            tx.send(std::to_string(i));
+        }
+    });
+    int expected = 0;
+    while (auto value = rx.receive()) {
+        assert(*value == std::to_string(expected));
+        expected++;
+    }
+    producer.join();
+    assert(expected == 10000);
+
+    // Other policies work through handles too
+    auto [utx, urx] = make_channel<int, ChannelPolicy<>>(0);
+    std::thread sender([tx = std::move(utx)] { tx.send(42); });
+    assert(*urx.receive() == 42);
+    sender.join();
+    assert(urx.is_closed());
+
+    try {
+        make_channel<int>(0);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::invalid_argument& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    log("Ordered transfer test completed");
+}
+
+void test_range_over_receiver() {
+    log("Testing range-based iteration over a receiver");
+    auto [tx, rx] = make_channel<int>(16);
+    std::thread producer([tx = std::move(tx)] {
+        for (int i = 0; i < 1000; ++i) {
+            tx.send(i);
+        }
+    });  // Dropping the last sender ends the loop
+    int expected = 0;
+    for (int value : rx) {
+        assert(value == expected++);
+    }
+    producer.join();
+    assert(expected == 1000);
+    log("Receiver range test completed");
+}
+
+int main() {
+    log("Starting channel handle tests");
+
+    test_close_on_last_sender();
+    test_close_on_last_receiver();
+    test_spsc_to_mpmc();
+    test_single_handles_in_order();
+    test_range_over_receiver();
+
+    log("All tests completed successfully");
+    return 0;
+}
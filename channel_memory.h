@@ -0,0 +1,436 @@
+#ifndef CHANNEL_MEMORY_H
+#define CHANNEL_MEMORY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Where the pages holding a ring channel's slots are placed on a NUMA
+ * machine.
+ */
+enum class NumaPlacement {
+    first_touch,     // Kernel default: the node of the thread touching a page
+    consumer_local,  // Moved to the node of the first receiving thread
+    interleaved,     // Spread page by page over all allowed nodes
+    node,            // Bound to StorageOptions::numa_node
+};
+
+/**
+ * @brief How the pages of a mapped ring storage are backed.
+ */
+enum class PageBacking {
+    regular,           // Base pages
+    transparent_huge,  // Regular mapping advised with MADV_HUGEPAGE
+    hugetlb,           // From the reserved huge page pool (MAP_HUGETLB)
+};
+
+/**
+ * @brief Memory options for the slots of a channel with ring storage.
+ *
+ * With the default options the slots come from the heap. Any other option
+ * maps the slots separately so the policy covers exactly their pages. The
+ * NUMA policy is applied with the mbind system call; where it is unavailable
+ * (no NUMA support, non-Linux systems) the slots behave as with first_touch.
+ *
+ * huge_pages backs the slots with 2 MiB pages, from the reserved pool if it
+ * has room and as transparent huge pages otherwise, which cuts TLB misses on
+ * rings of many megabytes. prefault touches every page at construction, so
+ * the first burst of traffic does not take page faults.
+ *
+ * preallocate applies to dynamic storage instead: the buffer for the whole
+ * capacity is allocated at construction, so the channel never allocates
+ * afterwards. Without it the buffer grows with the number of queued values,
+ * which suits channels whose large bound only serves as backpressure.
+ *
+ * Example: Channel<Tick, ChannelPolicy<single, single, bounded_ring>> ch(
+ *              4096, StorageOptions::on_node(1));
+ */
+struct StorageOptions {
+    NumaPlacement placement = NumaPlacement::first_touch;
+    int numa_node = -1;  // Node used by NumaPlacement::node
+    bool huge_pages = false;
+    bool prefault = false;
+    bool preallocate = false;  // Dynamic storage: reserve the capacity
+
+    /**
+     * @brief Returns options binding the slots to a NUMA node.
+     */
+    static StorageOptions on_node(int node) {
+        StorageOptions options;
+        options.placement = NumaPlacement::node;
+        options.numa_node = node;
+        return options;
+    }
+
+    /**
+     * @brief Returns options allocating the buffer of a dynamic channel at
+     * construction.
+     */
+    static StorageOptions preallocated() {
+        StorageOptions options;
+        options.preallocate = true;
+        return options;
+    }
+
+    /**
+     * @brief Checks if the slots need their own mapping instead of the heap.
+     */
+    bool needs_mapping() const {
+        return placement != NumaPlacement::first_touch || huge_pages ||
+               prefault;
+    }
+};
+
+namespace detail {
+
+// Node masks passed to the kernel cover this many nodes, the largest
+// configuration Linux supports
+constexpr size_t kMaxNumaNodes = 1024;
+using NodeMask =
+    std::array<unsigned long, kMaxNumaNodes / (8 * sizeof(unsigned long))>;
+
+// Memory policy constants of the Linux ABI, as defined by <numaif.h>. They
+// are repeated here so that using the channel does not require libnuma.
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolBind = 2;
+constexpr int kMpolInterleave = 3;
+constexpr unsigned kMpolMfMove = 1u << 1;
+constexpr unsigned long kMpolFMemsAllowed = 1ul << 2;
+
+// The huge page size of x86-64 and of arm64 with 4 KiB base pages
+constexpr size_t kHugePageSize = size_t(2) << 20;
+
+/**
+ * @brief Applies a memory policy to a page-aligned range. Returns false if
+ * the kernel rejected it, e.g. when NUMA support is missing.
+ */
+inline bool bind_memory([[maybe_unused]] void* address,
+                        [[maybe_unused]] size_t bytes,
+                        [[maybe_unused]] int mode,
+                        [[maybe_unused]] const NodeMask& nodes,
+                        [[maybe_unused]] unsigned flags = 0) {
+#if defined(__linux__) && defined(SYS_mbind)
+    // The kernel reads maxnode - 1 bits of the mask
+    return syscall(SYS_mbind, address, bytes, mode, nodes.data(),
+                   kMaxNumaNodes + 1, flags) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Returns the NUMA nodes the calling process may allocate from, in
+ * ascending order. A machine without NUMA support reports node 0 only.
+ */
+inline const std::vector<int>& numa_nodes() {
+    static const std::vector<int> nodes = [] {
+        std::vector<int> result;
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+        NodeMask mask{};
+        int mode = 0;
+        if (syscall(SYS_get_mempolicy, &mode, mask.data(), kMaxNumaNodes + 1,
+                    nullptr, kMpolFMemsAllowed) == 0) {
+            constexpr size_t kBits = 8 * sizeof(unsigned long);
+            for (size_t node = 0; node < kMaxNumaNodes; ++node) {
+                if (mask[node / kBits] & (1ul << (node % kBits))) {
+                    result.push_back(static_cast<int>(node));
+                }
+            }
+        }
+#endif
+        if (result.empty()) {
+            result.push_back(0);
+        }
+        return result;
+    }();
+    return nodes;
+}
+
+/**
+ * @brief Returns the NUMA node of the CPU the calling thread runs on, or 0
+ * if it cannot be determined. The thread may migrate right after the call.
+ */
+inline int current_numa_node() {
+#if defined(__linux__)
+    unsigned cpu = 0;
+    unsigned node = 0;
+#if defined(__GLIBC__) && \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    // Served from the vDSO, without entering the kernel
+    if (getcpu(&cpu, &node) == 0) {
+        return static_cast<int>(node);
+    }
+#elif defined(SYS_getcpu)
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+#endif
+    return 0;
+}
+
+inline NodeMask node_mask(int node) {
+    NodeMask mask{};
+    constexpr size_t kBits = 8 * sizeof(unsigned long);
+    if (node >= 0 && static_cast<size_t>(node) < kMaxNumaNodes) {
+        mask[node / kBits] |= 1ul << (node % kBits);
+    }
+    return mask;
+}
+
+/**
+ * @brief An anonymous memory mapping with a NUMA placement and optional huge
+ * pages.
+ *
+ * Unless prefault is set, the pages are not touched here, so the first write
+ * to each page allocates it under the policy set at construction.
+ */
+class MappedMemory {
+   public:
+    MappedMemory() = default;
+
+    /**
+     * @brief Maps at least bytes bytes of zeroed memory.
+     * @throws std::length_error if bytes rounded up to whole pages does not
+     * fit in a size_t.
+     * @throws std::bad_alloc if the mapping fails.
+     */
+    MappedMemory(size_t bytes, const StorageOptions& options) {
+#if defined(__linux__)
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t granule = options.huge_pages ? kHugePageSize : page;
+        if (bytes > std::numeric_limits<size_t>::max() - (granule - 1)) {
+            throw std::length_error("Channel buffer too large");
+        }
+        length =
+            (std::max<size_t>(bytes, 1) + granule - 1) / granule * granule;
+        if (options.huge_pages) {
+            map_huge();
+        } else {
+            address = map(length, 0);
+        }
+        if (!address) {
+            throw std::bad_alloc();
+        }
+        // The policy must be set before the pages are touched
+        place(options);
+        if (options.prefault) {
+            // Writing makes the kernel allocate; reading would map the
+            // shared zero page
+            auto* touch = static_cast<volatile char*>(address);
+            for (size_t offset = 0; offset < length; offset += page) {
+                touch[offset] = 0;
+            }
+        }
+#else
+        length = bytes;
+        address = ::operator new(bytes);
+        std::memset(address, 0, bytes);
+        (void)options;
+#endif
+    }
+
+    MappedMemory(MappedMemory&& other) noexcept
+        : address(std::exchange(other.address, nullptr)),
+          length(std::exchange(other.length, 0)),
+          placed(other.placed),
+          backing(other.backing) {}
+
+    MappedMemory& operator=(MappedMemory&& other) noexcept {
+        std::swap(address, other.address);
+        std::swap(length, other.length);
+        std::swap(placed, other.placed);
+        std::swap(backing, other.backing);
+        return *this;
+    }
+
+    ~MappedMemory() {
+        if (!address) {
+            return;
+        }
+#if defined(__linux__)
+        munmap(address, length);
+#else
+        ::operator delete(address);
+#endif
+    }
+
+    void* data() const { return address; }
+    size_t size() const { return length; }
+
+    /**
+     * @brief Checks if the kernel accepted the NUMA placement.
+     */
+    bool is_placed() const { return placed; }
+
+    /**
+     * @brief Returns how the pages are backed.
+     */
+    PageBacking page_backing() const { return backing; }
+
+    /**
+     * @brief Moves the pages to the node of the calling thread and makes it
+     * the preferred node for pages not allocated yet.
+     */
+    void move_to_current_node() {
+        placed = bind_memory(address, length, kMpolPreferred,
+                             node_mask(current_numa_node()), kMpolMfMove);
+    }
+
+   private:
+#if defined(__linux__)
+    static void* map(size_t bytes, int flags) {
+        void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+        return mapped == MAP_FAILED ? nullptr : mapped;
+    }
+
+    /**
+     * @brief Maps length bytes of huge pages: from the reserved pool when
+     * it has room, otherwise as a huge-page-aligned regular mapping advised
+     * for transparent huge pages. Falls back to base pages if neither is
+     * available.
+     */
+    void map_huge() {
+#if defined(MAP_HUGETLB)
+        if ((address = map(length, MAP_HUGETLB))) {
+            backing = PageBacking::hugetlb;
+            return;
+        }
+#endif
+        // Over-allocate, then trim to a huge page boundary on both ends
+        auto* raw = static_cast<char*>(map(length + kHugePageSize, 0));
+        if (!raw) {
+            return;
+        }
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        char* aligned = raw + (kHugePageSize - start % kHugePageSize) %
+                                  kHugePageSize;
+        if (aligned > raw) {
+            munmap(raw, aligned - raw);
+        }
+        size_t tail = raw + length + kHugePageSize - (aligned + length);
+        if (tail > 0) {
+            munmap(aligned + length, tail);
+        }
+        address = aligned;
+#if defined(MADV_HUGEPAGE)
+        if (madvise(address, length, MADV_HUGEPAGE) == 0) {
+            backing = PageBacking::transparent_huge;
+        }
+#endif
+    }
+#endif
+
+    void place(const StorageOptions& options) {
+        switch (options.placement) {
+            case NumaPlacement::node:
+                placed = bind_memory(address, length, kMpolBind,
+                                     node_mask(options.numa_node));
+                break;
+            case NumaPlacement::interleaved: {
+                NodeMask mask{};
+                for (int node : numa_nodes()) {
+                    NodeMask single = node_mask(node);
+                    for (size_t i = 0; i < mask.size(); ++i) {
+                        mask[i] |= single[i];
+                    }
+                }
+                placed = bind_memory(address, length, kMpolInterleave, mask);
+                break;
+            }
+            case NumaPlacement::consumer_local:
+            case NumaPlacement::first_touch:
+                // Placed later by move_to_current_node(), or by the kernel
+                break;
+        }
+    }
+
+    void* address = nullptr;
+    size_t length = 0;
+    bool placed = false;
+    PageBacking backing = PageBacking::regular;
+};
+
+/**
+ * @brief The slots of a RingBuffer with a runtime capacity: from a memory
+ * resource by default, or in a MappedMemory when the options ask for a
+ * placement.
+ */
+template <typename Slot>
+class SlotArray {
+   public:
+    /**
+     * @throws std::length_error if count slots do not fit in a size_t.
+     */
+    SlotArray(size_t count, const StorageOptions& options,
+              std::pmr::memory_resource* resource)
+        : pending_consumer(options.placement ==
+                           NumaPlacement::consumer_local) {
+        if (count > std::numeric_limits<size_t>::max() / sizeof(Slot)) {
+            throw std::length_error("Channel buffer too large");
+        }
+        if (options.needs_mapping()) {
+            mapped = MappedMemory(count * sizeof(Slot), options);
+            base = static_cast<Slot*>(mapped.data());
+        } else {
+            base = static_cast<Slot*>(
+                resource->allocate(count * sizeof(Slot), alignof(Slot)));
+            owner = resource;
+            slot_count = count;
+        }
+    }
+
+    SlotArray(const SlotArray&) = delete;
+    SlotArray& operator=(const SlotArray&) = delete;
+
+    ~SlotArray() {
+        if (owner) {
+            owner->deallocate(base, slot_count * sizeof(Slot), alignof(Slot));
+        }
+    }
+
+    Slot& operator[](size_t index) { return base[index]; }
+
+    const MappedMemory& memory() const { return mapped; }
+
+    /**
+     * @brief Applies NumaPlacement::consumer_local the first time a consumer
+     * calls it; a relaxed load afterwards.
+     */
+    void adopt_consumer_node() {
+        if (pending_consumer.load(std::memory_order_relaxed) &&
+            pending_consumer.exchange(false, std::memory_order_relaxed)) {
+            mapped.move_to_current_node();
+        }
+    }
+
+   private:
+    MappedMemory mapped;
+    Slot* base;
+    std::pmr::memory_resource* owner = nullptr;  // Set if base came from it
+    size_t slot_count = 0;
+    std::atomic<bool> pending_consumer;
+};
+
+}  // namespace detail
+
+#endif  // CHANNEL_MEMORY_H
@@ -0,0 +1,397 @@
+#ifndef CHANNEL_POLICY_H
+#define CHANNEL_POLICY_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <cpuid.h>
+#include <immintrin.h>
+#include <x86intrin.h>
+#define CHANNEL_HAS_WAITPKG_INTRINSICS 1
+#endif
+
+/**
+ * @brief Tags describing how a Channel is used, selected at compile time.
+ *
+ * A Channel is parameterized by a ChannelPolicy built from one tag of each
+ * group below. The default policy (multi, multi, dynamic, block) is the
+ * general mutex-based channel whose behaviour depends on the capacity passed
+ * at runtime.
+ */
+namespace channel_policy {
+
+// Producer/consumer cardinality
+struct single {};   // At most one thread uses this side at a time
+struct multi {};    // Any number of threads use this side concurrently
+struct counted {};  // Decided at runtime from the live Sender/Receiver handles
+
+// Storage
+struct dynamic {};       // Unbuffered if capacity is 0, bounded otherwise
+struct bounded_ring {};  // Preallocated ring of `capacity` slots
+struct unbounded {};     // Grows as needed, senders never block
+struct rendezvous {};    // Unbuffered, every send meets a receive
+
+// Ring of N slots embedded in the channel object, no heap allocation
+template <size_t N>
+struct static_ring {
+    static_assert(N > 0, "A static ring needs at least one slot");
+    static constexpr size_t capacity = N;
+};
+
+// Capacity of a static_ring storage tag, 0 for any other storage
+template <typename Storage>
+struct static_capacity : std::integral_constant<size_t, 0> {};
+template <size_t N>
+struct static_capacity<static_ring<N>> : std::integral_constant<size_t, N> {};
+
+// Wait strategy
+struct block {};     // Sleep on condition variables
+struct spin {};      // Busy-wait on the channel state, never sleep
+struct adaptive {};  // Block while calm, spin briefly first under contention
+struct poll {};      // Busy-poll without yielding, for dedicated cores
+
+// Sender fairness on a full channel
+struct barging {};  // A freed slot goes to whichever sender gets there first
+struct fifo {};     // Blocked senders queue up and get freed slots in order
+
+}  // namespace channel_policy
+
+/**
+ * @brief Compile-time description of a Channel.
+ *
+ * @tparam Producers channel_policy::single, multi or counted.
+ * @tparam Consumers channel_policy::single, multi or counted.
+ * @tparam Storage channel_policy::dynamic, bounded_ring, static_ring<N>,
+ * unbounded or rendezvous.
+ * @tparam Wait channel_policy::block, spin, adaptive or poll.
+ * @tparam Fairness channel_policy::barging or fifo. Only affects channels
+ * using the mutex algorithm; a lock-free ring has one sender at a time.
+ *
+ * Example: Channel<int, ChannelPolicy<channel_policy::single,
+ *                                     channel_policy::single,
+ *                                     channel_policy::bounded_ring>> ch(1024);
+ */
+template <typename Producers = channel_policy::multi,
+          typename Consumers = channel_policy::multi,
+          typename Storage = channel_policy::dynamic,
+          typename Wait = channel_policy::block,
+          typename Fairness = channel_policy::barging>
+struct ChannelPolicy {
+    static_assert(std::is_same_v<Producers, channel_policy::single> ||
+                      std::is_same_v<Producers, channel_policy::multi> ||
+                      std::is_same_v<Producers, channel_policy::counted>,
+                  "Producers must be channel_policy::single, multi or counted");
+    static_assert(std::is_same_v<Consumers, channel_policy::single> ||
+                      std::is_same_v<Consumers, channel_policy::multi> ||
+                      std::is_same_v<Consumers, channel_policy::counted>,
+                  "Consumers must be channel_policy::single, multi or counted");
+    static_assert(std::is_same_v<Storage, channel_policy::dynamic> ||
+                      std::is_same_v<Storage, channel_policy::bounded_ring> ||
+                      std::is_same_v<Storage, channel_policy::unbounded> ||
+                      std::is_same_v<Storage, channel_policy::rendezvous> ||
+                      channel_policy::static_capacity<Storage>::value > 0,
+                  "Unknown channel storage");
+    static_assert(std::is_same_v<Wait, channel_policy::block> ||
+                      std::is_same_v<Wait, channel_policy::spin> ||
+                      std::is_same_v<Wait, channel_policy::adaptive> ||
+                      std::is_same_v<Wait, channel_policy::poll>,
+                  "Unknown channel wait strategy");
+    static_assert(std::is_same_v<Fairness, channel_policy::barging> ||
+                      std::is_same_v<Fairness, channel_policy::fifo>,
+                  "Fairness must be channel_policy::barging or fifo");
+
+    using producers = Producers;
+    using consumers = Consumers;
+    using storage = Storage;
+    using wait = Wait;
+    using fairness = Fairness;
+
+    static constexpr bool single_producer =
+        std::is_same_v<Producers, channel_policy::single>;
+    static constexpr bool single_consumer =
+        std::is_same_v<Consumers, channel_policy::single>;
+    static constexpr bool counted_producers =
+        std::is_same_v<Producers, channel_policy::counted>;
+    static constexpr bool counted_consumers =
+        std::is_same_v<Consumers, channel_policy::counted>;
+    static constexpr size_t static_capacity =
+        channel_policy::static_capacity<Storage>::value;
+    static constexpr bool ring_storage =
+        std::is_same_v<Storage, channel_policy::bounded_ring> ||
+        static_capacity > 0;
+    static constexpr bool adaptive =
+        std::is_same_v<Wait, channel_policy::adaptive>;
+    static constexpr bool polling = std::is_same_v<Wait, channel_policy::poll>;
+    static constexpr bool blocking =
+        std::is_same_v<Wait, channel_policy::block> || adaptive;
+
+    // One producer and one consumer on a ring need no lock on the data path.
+    // A counted side only takes a lock while several handles share it.
+    static constexpr bool lock_free =
+        (single_producer || counted_producers) &&
+        (single_consumer || counted_consumers) && ring_storage;
+
+    // Blocked senders wait in a FIFO queue and are handed freed slots
+    static constexpr bool fifo_senders =
+        std::is_same_v<Fairness, channel_policy::fifo> && !lock_free;
+};
+
+using DefaultChannelPolicy = ChannelPolicy<>;
+
+template <typename T, typename Policy = DefaultChannelPolicy>
+class Channel;
+
+// Common configurations
+template <typename T, typename Wait = channel_policy::block>
+using SpscChannel = Channel<T, ChannelPolicy<channel_policy::single,
+                                             channel_policy::single,
+                                             channel_policy::bounded_ring,
+                                             Wait>>;
+template <typename T, typename Wait = channel_policy::block>
+using MpscChannel = Channel<T, ChannelPolicy<channel_policy::multi,
+                                             channel_policy::single,
+                                             channel_policy::bounded_ring,
+                                             Wait>>;
+template <typename T, size_t N, typename Producers = channel_policy::multi,
+          typename Consumers = channel_policy::multi,
+          typename Wait = channel_policy::block>
+using StaticChannel =
+    Channel<T, ChannelPolicy<Producers, Consumers,
+                             channel_policy::static_ring<N>, Wait>>;
+template <typename T>
+using AdaptiveChannel =
+    Channel<T, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                             channel_policy::dynamic,
+                             channel_policy::adaptive>>;
+template <typename T>
+using FairChannel =
+    Channel<T, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                             channel_policy::dynamic, channel_policy::block,
+                             channel_policy::fifo>>;
+template <typename T>
+using UnboundedChannel =
+    Channel<T, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                             channel_policy::unbounded>>;
+template <typename T>
+using RendezvousChannel =
+    Channel<T, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                             channel_policy::rendezvous>>;
+
+namespace detail {
+
+/**
+ * @brief Hints the CPU that we are in a spin loop.
+ */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * @brief A small number identifying the calling thread, used to spread
+ * threads over per-thread slots.
+ */
+inline size_t thread_index() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+/**
+ * @brief Spins with exponential backoff, yielding the thread once the
+ * backoff is exhausted.
+ */
+class Backoff {
+   public:
+    void pause() {
+        if (step < kSpinLimit) {
+            for (unsigned i = 0; i < (1u << step); ++i) {
+                cpu_relax();
+            }
+            ++step;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+   private:
+    static constexpr unsigned kSpinLimit = 6;
+    unsigned step = 0;
+};
+
+/**
+ * @brief Checks once whether the CPU supports UMONITOR/UMWAIT/TPAUSE
+ * (CPUID.7.0:ECX.WAITPKG).
+ */
+inline bool cpu_has_waitpkg() {
+#ifdef CHANNEL_HAS_WAITPKG_INTRINSICS
+    static const bool supported = [] {
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+        return (ecx & (1u << 5)) != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+#ifdef CHANNEL_HAS_WAITPKG_INTRINSICS
+// Compiled for WAITPKG regardless of -march; only called after
+// cpu_has_waitpkg() returned true. State 1 (C0.1) trades a little power for
+// the fastest wakeup.
+__attribute__((target("waitpkg"))) inline void umonitor(const void* address) {
+    _umonitor(const_cast<void*>(address));
+}
+__attribute__((target("waitpkg"))) inline void umwait(uint64_t cycles) {
+    _umwait(1, __rdtsc() + cycles);
+}
+__attribute__((target("waitpkg"))) inline void tpause(uint64_t cycles) {
+    _tpause(1, __rdtsc() + cycles);
+}
+#endif
+
+/**
+ * @brief Busy-polls for a change without ever entering the kernel.
+ *
+ * With WAITPKG, wait() arms a monitor on the cache line at address and
+ * sleeps in C0.1 until another core writes it, or pauses briefly with TPAUSE
+ * when there is no address to watch. Without WAITPKG it falls back to pause.
+ * The waits are bounded, so state changes elsewhere (close, cancel, a
+ * deadline) are still noticed within a microsecond or so.
+ */
+class Poller {
+   public:
+    explicit Poller(const void* address = nullptr)
+        : address(address), waitpkg(cpu_has_waitpkg()) {}
+
+    template <typename Predicate>
+    void wait([[maybe_unused]] Predicate pred) {
+#ifdef CHANNEL_HAS_WAITPKG_INTRINSICS
+        if (waitpkg) {
+            if (address) {
+                umonitor(address);
+                // A write between the caller's check and arming the monitor
+                // would not wake us
+                if (!pred()) {
+                    umwait(kMonitorCycles);
+                }
+            } else {
+                tpause(kPauseCycles);
+            }
+            return;
+        }
+#endif
+        cpu_relax();
+    }
+
+    // Without an address to watch there is nothing to check in between
+    void wait() {
+        wait([] { return false; });
+    }
+
+   private:
+    static constexpr uint64_t kMonitorCycles = 4000;
+    static constexpr uint64_t kPauseCycles = 200;
+
+    const void* address;
+    bool waitpkg;
+};
+
+/**
+ * @brief Tracks how often a lock was found taken, as an exponentially decayed
+ * score, and decides whether the lock counts as contended.
+ *
+ * Every acquisition adds a sample: the score loses 1/16 of its value and
+ * gains kWeight if the lock was taken. It settles around 16 * kWeight times
+ * the contended fraction. The lock becomes contended above kUpgradeScore
+ * (about 25% of acquisitions) and calm again below kDowngradeScore (about
+ * 6%), so the mode doesn't flap around a single threshold.
+ *
+ * Updates are relaxed and may race; the score is a heuristic.
+ */
+class ContentionMonitor {
+   public:
+    static constexpr uint32_t kWeight = 64;
+    static constexpr uint32_t kUpgradeScore = 4 * kWeight;
+    static constexpr uint32_t kDowngradeScore = kWeight;
+
+    void record(bool contended_acquire) {
+        uint32_t s = score.load(std::memory_order_relaxed);
+        s = s - (s >> 4) + (contended_acquire ? kWeight : 0);
+        score.store(s, std::memory_order_relaxed);
+        bool was = contended.load(std::memory_order_relaxed);
+        if (!was && s > kUpgradeScore) {
+            contended.store(true, std::memory_order_relaxed);
+        } else if (was && s < kDowngradeScore) {
+            contended.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    bool is_contended() const {
+        return contended.load(std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<uint32_t> score{0};
+    std::atomic<bool> contended{false};
+};
+
+/**
+ * @brief Detects concurrent use of a side of a channel that was declared
+ * channel_policy::single. Compiles to nothing unless Enabled and assertions
+ * are on (i.e. NDEBUG is not defined).
+ */
+template <bool Enabled>
+class SingleUseChecker {
+   public:
+    class Guard {
+       public:
+        explicit Guard([[maybe_unused]] SingleUseChecker& checker) {
+#ifndef NDEBUG
+            if constexpr (Enabled) {
+                active = &checker.active;
+                int previous = active->fetch_add(1, std::memory_order_acquire);
+                assert(previous == 0 &&
+                       "Concurrent use of a channel side declared single");
+                (void)previous;
+            }
+#endif
+        }
+        ~Guard() {
+#ifndef NDEBUG
+            if constexpr (Enabled) {
+                active->fetch_sub(1, std::memory_order_release);
+            }
+#endif
+        }
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+       private:
+#ifndef NDEBUG
+        std::atomic<int>* active = nullptr;
+#endif
+    };
+
+   private:
+#ifndef NDEBUG
+    std::atomic<int> active{0};
+#endif
+};
+
+}  // namespace detail
+
+#endif  // CHANNEL_POLICY_H
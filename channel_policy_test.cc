@@ -0,0 +1,443 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "channel.h"
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+template <typename Ch>
+void check_ordered_transfer(Ch& ch, int count) {
+    std::thread producer([&ch, count] {
+        for (int i = 0; i < count; ++i) {
+            ch.send(i);
+        }
+        ch.close();
+    });
+    int expected = 0;
+    while (auto value = ch.receive()) {
+        assert(*value == expected && "Values out of order");
+        expected++;
+    }
+    producer.join();
+    assert(expected == count && "Lost values");
+}
+
+void test_spsc_ring() {
+    log("Testing lock-free SPSC ring channel");
+    static_assert(SpscChannel<int>::policy_type::lock_free);
+
+    SpscChannel<int> ch(16);
+    check_ordered_transfer(ch, 200000);
+
+    SpscChannel<int> small(1);
+    assert(small.try_send(1) && !small.try_send(2) && small.size() == 1);
+    assert(*small.try_receive() == 1 && small.is_empty());
+
+    try {
+        SpscChannel<int> invalid(0);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::invalid_argument& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    log("SPSC ring test completed");
+}
+
+void test_spsc_spin() {
+    log("Testing spinning SPSC ring channel");
+    SpscChannel<int, channel_policy::spin> ch(8);
+    check_ordered_transfer(ch, 100000);
+    log("Spinning SPSC test completed");
+}
+
+void test_spsc_close_and_cancel() {
+    log("Testing close and cancellation on SPSC ring");
+    SpscChannel<int> ch(1);
+    ch.send(1);
+
+    CancellationToken token;
+    std::thread blocked([&ch, &token] { assert(!ch.send(2, token)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    token.cancel();
+    blocked.join();
+
+    std::thread closer([&ch] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        ch.close();
+    });
+    assert(*ch.receive() == 1 && "Value sent before close was lost");
+    assert(!ch.receive() && "Receive should return nullopt after close");
+    closer.join();
+    try {
+        ch.send(3);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::runtime_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    log("SPSC close and cancellation test completed");
+}
+
+void test_mpsc_ring() {
+    log("Testing MPSC ring channel");
+    MpscChannel<int> ch(4);
+    const int num_producers = 4;
+    const int per_producer = 5000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&ch, p] {
+            for (int i = 0; i < per_producer; ++i) {
+                ch.send(p * per_producer + i);
+            }
+        });
+    }
+    std::vector<int> last(num_producers, -1);
+    for (int n = 0; n < num_producers * per_producer; ++n) {
+        int value = *ch.receive();
+        int p = value / per_producer;
+        assert(value > last[p] && "Per-producer order violated");
+        last[p] = value;
+    }
+    for (auto& t : producers) t.join();
+    log("MPSC ring test completed");
+}
+
+void test_unbounded_and_rendezvous() {
+    log("Testing unbounded and rendezvous storage");
+    UnboundedChannel<int> unbounded(1);  // Capacity is ignored
+    for (int i = 0; i < 1000; ++i) {
+        assert(unbounded.try_send(i) && "Unbounded send should never fail");
+    }
+    assert(unbounded.size() == 1000);
+
+    RendezvousChannel<int> rendezvous(10);  // Capacity is ignored
+    std::atomic<bool> sent(false);
+    std::thread sender([&rendezvous, &sent] {
+        rendezvous.send(1);
+        sent = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!sent && "Rendezvous send completed without a receiver");
+    assert(*rendezvous.receive() == 1);
+    sender.join();
+    log("Unbounded and rendezvous test completed");
+}
+
+void test_selector_on_spsc() {
+    log("Testing selector on SPSC ring");
+    SpscChannel<int> ch(4);
+    Selector selector;
+    int sum = 0;
+    selector.add_receive<int>(ch, [&sum](int value) { sum += value; });
+    std::thread producer([&ch] {
+        for (int i = 1; i <= 100; ++i) {
+            ch.send(i);
+        }
+        ch.close();  // Values still buffered must reach the callback
+    });
+    selector.select();
+    producer.join();
+    assert(sum == 5050 && "Selector missed values");
+    log("Selector on SPSC test completed");
+}
+
+// Lives in static storage: no heap allocation for the buffer
+StaticChannel<int, 4> static_ch;
+
+void test_static_channel() {
+    log("Testing statically sized channels");
+    using Spsc = StaticChannel<int, 64, channel_policy::single,
+                               channel_policy::single>;
+    static_assert(Spsc::policy_type::static_capacity == 64);
+    static_assert(Spsc::policy_type::lock_free);
+    static_assert(sizeof(Spsc) >= 64 * sizeof(int));
+
+    // Fill and drain more than once so positions wrap
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            assert(static_ch.try_send(i));
+        }
+        assert(!static_ch.try_send(4) && static_ch.size() == 4);
+        for (int i = 0; i < 4; ++i) {
+            assert(*static_ch.try_receive() == i);
+        }
+    }
+
+    Spsc spsc;
+    check_ordered_transfer(spsc, 100000);
+
+    // A capacity that is not a power of two wraps with a modulo
+    StaticChannel<std::string, 3> odd;
+    for (int i = 0; i < 10; ++i) {
+        odd.send(std::to_string(i));
+        assert(*odd.receive() == std::to_string(i));
+    }
+    log("Static channel test completed");
+}
+
+void test_adaptive_channel() {
+    log("Testing adaptive channel");
+    detail::ContentionMonitor monitor;
+    // Upgrades once most acquisitions find the lock taken
+    for (int i = 0; i < 8; ++i) {
+        monitor.record(true);
+    }
+    assert(monitor.is_contended());
+    // A little calm traffic is not enough to downgrade...
+    for (int i = 0; i < 8; ++i) {
+        monitor.record(false);
+    }
+    assert(monitor.is_contended());
+    // ...but a sustained calm period is
+    for (int i = 0; i < 100; ++i) {
+        monitor.record(false);
+    }
+    assert(!monitor.is_contended());
+
+    AdaptiveChannel<int> ch(4);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&ch] {
+            for (int i = 0; i < 20000; ++i) {
+                ch.send(1);
+            }
+        });
+    }
+    std::atomic<int> received{0};
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 4; ++c) {
+        consumers.emplace_back([&ch, &received] {
+            while (auto value = ch.receive()) {
+                received += *value;
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    ch.close();
+    for (auto& t : consumers) {
+        t.join();
+    }
+    assert(received == 80000 && "Lost values");
+
+    // Uncontended traffic brings it back to the cheap path
+    AdaptiveChannel<int> calm(1);
+    for (int i = 0; i < 100; ++i) {
+        calm.send(i);
+        calm.receive();
+    }
+    assert(!calm.is_contended() && !Channel<int>().is_contended());
+    log("Adaptive channel test completed");
+}
+
+void test_poll_channel() {
+    log(std::string("Testing polling channels, WAITPKG ") +
+        (detail::cpu_has_waitpkg() ? "available" : "not available"));
+    // Polling never yields, so on a machine with fewer cores than threads
+    // each handoff costs a scheduler tick; keep the counts small
+    SpscChannel<int, channel_policy::poll> ring(256);
+    check_ordered_transfer(ring, 5000);
+
+    Channel<int, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                               channel_policy::dynamic, channel_policy::poll>>
+        locked(64);
+    check_ordered_transfer(locked, 2000);
+
+    SpscChannel<int, channel_policy::poll> idle(4);
+    int value;
+    assert(idle.receive_status_for(value, std::chrono::milliseconds(5)) ==
+           ChannelStatus::timeout);
+    log("Polling channel test completed");
+}
+
+void test_single_producer_misuse() {
+#ifndef NDEBUG
+    log("Testing detection of a second producer on an SPSC channel");
+    pid_t pid = fork();
+    if (pid == 0) {
+        // Child: two producers block on a full channel at the same time
+        freopen("/dev/null", "w", stderr);  // Silence the expected assertion
+        SpscChannel<int> ch(1);
+        ch.send(0);
+        std::thread a([&ch] { ch.send(1); });
+        std::thread b([&ch] { ch.send(2); });
+        a.join();
+        b.join();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    assert(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT &&
+           "Concurrent producers were not detected");
+    log("Misuse detection test completed");
+#endif
+}
+
+void test_fifo_senders() {
+    log("Testing FIFO sender fairness");
+    FairChannel<int> ch(1);
+    ch.send(0);
+    // Senders block on the full channel in the order they arrive
+    std::vector<std::thread> senders;
+    for (int i = 1; i <= 4; ++i) {
+        senders.emplace_back([&ch, i] { ch.send(i); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    assert(*ch.receive() == 0);
+    // The freed slot is reserved for the oldest waiter, not up for grabs
+    assert(!ch.try_send(99) && "Barged ahead of a blocked sender");
+    for (int i = 1; i <= 4; ++i) {
+        assert(*ch.receive() == i && "Senders served out of order");
+    }
+    for (auto& t : senders) {
+        t.join();
+    }
+
+    // Waiters that time out or are cancelled leave the queue, and those
+    // behind them still get the slots
+    ch.send(10);
+    ChannelStatus timed_out = ChannelStatus::ok;
+    ChannelStatus cancelled = ChannelStatus::ok;
+    CancellationToken token;
+    std::thread first([&] {
+        timed_out = ch.send_status_for(11, std::chrono::milliseconds(50));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::thread second([&] { cancelled = ch.send_status(12, token); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::thread third([&ch] { ch.send(13); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    token.cancel();
+    first.join();
+    second.join();
+    assert(timed_out == ChannelStatus::timeout);
+    assert(cancelled == ChannelStatus::cancelled);
+    assert(*ch.receive() == 10 && *ch.receive() == 13);
+    third.join();
+
+    // Closing releases queued senders
+    ch.send(20);
+    ChannelStatus status = ChannelStatus::ok;
+    std::thread blocked([&] { status = ch.send_status(21); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ch.close();
+    blocked.join();
+    assert(status == ChannelStatus::closed);
+
+    // Many producers, batches and a spinning ring keep every value
+    Channel<int, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                               channel_policy::bounded_ring,
+                               channel_policy::spin, channel_policy::fifo>>
+        ring(4);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&ring] {
+            int batch[3] = {1, 1, 1};
+            for (int i = 0; i < 500; ++i) {
+                ring.send(1);
+                ring.send_batch(batch, 3);
+            }
+        });
+    }
+    int sum = 0;
+    int block[8];
+    while (sum < 4 * 500 * 4) {
+        sum += static_cast<int>(ring.receive_batch(block, 8));
+        if (auto value = ring.try_receive()) {
+            sum += *value;
+        }
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    assert(ring.is_empty());
+    log("FIFO sender test completed");
+}
+
+template <typename Ch>
+void check_exchange(Ch& ch, int pairs, int per_sender) {
+    std::vector<std::thread> threads;
+    std::atomic<long long> sum{0};
+    for (int p = 0; p < pairs; ++p) {
+        threads.emplace_back([&ch, p, per_sender] {
+            for (int i = 0; i < per_sender; ++i) {
+                ch.send(p * per_sender + i);
+            }
+        });
+        threads.emplace_back([&ch, &sum, per_sender] {
+            for (int i = 0; i < per_sender; ++i) {
+                sum += *ch.receive();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    long long n = static_cast<long long>(pairs) * per_sender;
+    assert(sum == n * (n - 1) / 2 && "Lost or duplicated values");
+}
+
+void test_rendezvous_elimination() {
+    log("Testing sender/receiver elimination on unbuffered channels");
+    // Values change hands through the elimination array or the queue, each
+    // exactly once
+    RendezvousChannel<int> rendezvous(0);
+    check_exchange(rendezvous, 4, 5000);
+    Channel<int> unbuffered(0);
+    check_exchange(unbuffered, 4, 5000);
+    Channel<int, ChannelPolicy<channel_policy::multi, channel_policy::multi,
+                               channel_policy::rendezvous,
+                               channel_policy::spin>>
+        spinning(0);
+    check_exchange(spinning, 2, 5000);
+
+    // Move-only values are moved out of the sender's offer
+    RendezvousChannel<std::unique_ptr<int>> pointers(0);
+    std::thread sender([&pointers] {
+        for (int i = 0; i < 1000; ++i) {
+            pointers.send(std::make_unique<int>(i));
+        }
+        pointers.close();
+    });
+    int expected = 0;
+    while (auto value = pointers.receive()) {
+        assert(**value == expected++);
+    }
+    sender.join();
+    assert(expected == 1000);
+    log("Elimination test completed");
+}
+
+int main() {
+    log("Starting channel policy tests");
+
+    test_spsc_ring();
+    test_spsc_spin();
+    test_spsc_close_and_cancel();
+    test_mpsc_ring();
+    test_unbounded_and_rendezvous();
+    test_selector_on_spsc();
+    test_static_channel();
+    test_adaptive_channel();
+    test_poll_channel();
+    test_single_producer_misuse();
+    test_fifo_senders();
+    test_rendezvous_elimination();
+
+    log("All tests completed successfully");
+    return 0;
+}
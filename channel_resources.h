@@ -0,0 +1,202 @@
+#ifndef CHANNEL_RESOURCES_H
+#define CHANNEL_RESOURCES_H
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <utility>
+
+/**
+ * @brief Returns a process-wide memory resource that recycles blocks through
+ * per-thread caches.
+ *
+ * Blocks of up to kMaxCachedBlock bytes are rounded up to a power of two, and
+ * a freed block goes to a free list of the freeing thread, from which that
+ * thread's next allocation of the same size class is served without a lock.
+ * Each block is an individual allocation of the upstream heap, so a block
+ * can be freed by any thread: with channels, the producer typically
+ * allocates a queue chunk and the consumer frees it. Larger or over-aligned
+ * blocks go straight to the heap.
+ *
+ * Use Case: Give many short-lived channels, or channels with a growable
+ * buffer, memory without contending on the global heap.
+ * Example: Channel<Job, ChannelPolicy<multi, multi, unbounded>> jobs(
+ *              0, thread_pool_resource());
+ */
+inline std::pmr::memory_resource* thread_pool_resource();
+
+/**
+ * @brief A thread-safe arena: allocations bump a pointer through blocks
+ * taken from upstream, deallocations are no-ops, and release() frees
+ * everything at once.
+ *
+ * Use Case: Build the channels of one request in an arena, destroy them when
+ * the request is done, and release the arena instead of returning every
+ * buffer chunk to the heap.
+ * Example: ChannelArena arena;
+ *          {
+ *              Channel<Row> rows(0, &arena);
+ *              ...
+ *          }
+ *          arena.release();
+ */
+class ChannelArena : public std::pmr::memory_resource {
+   public:
+    /**
+     * @brief Constructs an arena.
+     * @param initial_size The size of the first block taken from upstream.
+     * @param upstream The resource the blocks come from.
+     */
+    explicit ChannelArena(
+        size_t initial_size = 4096,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : arena(initial_size, upstream) {}
+
+    // Disable copying and moving
+    ChannelArena(const ChannelArena&) = delete;
+    ChannelArena& operator=(const ChannelArena&) = delete;
+
+    /**
+     * @brief Returns all memory to upstream. Every channel and selector using
+     * the arena must have been destroyed.
+     */
+    void release() {
+        std::unique_lock<std::mutex> lock(mtx);
+        arena.release();
+    }
+
+   private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        // Channels allocate under their own locks, but channels sharing an
+        // arena do not share a lock
+        std::unique_lock<std::mutex> lock(mtx);
+        return arena.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::mutex mtx;
+    std::pmr::monotonic_buffer_resource arena;
+};
+
+namespace detail {
+
+/**
+ * @brief The resource behind thread_pool_resource().
+ */
+class ThreadPoolResource : public std::pmr::memory_resource {
+   public:
+    // Larger blocks are not cached
+    static constexpr size_t kMaxCachedBlock = 4096;
+    // Blocks kept per size class and thread; the rest go back to the heap
+    static constexpr size_t kMaxCachedPerClass = 256;
+
+   private:
+    static constexpr size_t kMinBlockShift = 4;  // 16-byte blocks
+    static constexpr size_t kClasses = 9;        // 16 B .. 4 KiB
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // The free lists of one thread, emptied into the heap when it exits
+    struct Cache {
+        std::array<FreeBlock*, kClasses> heads{};
+        std::array<size_t, kClasses> counts{};
+
+        ~Cache() {
+            cache_gone() = true;
+            for (FreeBlock* head : heads) {
+                while (head) {
+                    ::operator delete(std::exchange(head, head->next));
+                }
+            }
+        }
+    };
+
+    static Cache& cache() {
+        thread_local Cache local;
+        return local;
+    }
+
+    // Set once the thread's cache is destroyed; blocks freed by destructors
+    // that run later in the thread's exit go straight to the heap. Trivially
+    // destructible, so it stays valid until the thread is gone.
+    static bool& cache_gone() {
+        thread_local bool gone = false;
+        return gone;
+    }
+
+    // The size class of a block, or kClasses if it is not cached
+    static size_t size_class(size_t bytes, size_t alignment) {
+        if (bytes > kMaxCachedBlock ||
+            alignment > alignof(std::max_align_t)) {
+            return kClasses;
+        }
+        size_t index = 0;
+        while ((size_t(1) << (index + kMinBlockShift)) < bytes) {
+            ++index;
+        }
+        return index;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        size_t index = size_class(bytes, alignment);
+        if (index == kClasses) {
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+        if (cache_gone()) {
+            return ::operator new(size_t(1) << (index + kMinBlockShift));
+        }
+        Cache& local = cache();
+        if (FreeBlock* block = local.heads[index]) {
+            local.heads[index] = block->next;
+            --local.counts[index];
+            return block;
+        }
+        return ::operator new(size_t(1) << (index + kMinBlockShift));
+    }
+
+    void do_deallocate(void* pointer, size_t bytes,
+                       size_t alignment) override {
+        size_t index = size_class(bytes, alignment);
+        if (index == kClasses) {
+            ::operator delete(pointer, std::align_val_t(alignment));
+            return;
+        }
+        if (cache_gone()) {
+            ::operator delete(pointer);
+            return;
+        }
+        Cache& local = cache();
+        if (local.counts[index] == kMaxCachedPerClass) {
+            ::operator delete(pointer);
+            return;
+        }
+        local.heads[index] = new (pointer) FreeBlock{local.heads[index]};
+        ++local.counts[index];
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+}  // namespace detail
+
+inline std::pmr::memory_resource* thread_pool_resource() {
+    // Never destroyed, so channels with static storage duration can still
+    // free their memory at exit
+    static auto* resource = new detail::ThreadPoolResource();
+    return resource;
+}
+
+#endif  // CHANNEL_RESOURCES_H
@@ -0,0 +1,174 @@
+#include "channel.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+// Forwards to the heap and keeps count, so tests can check who allocated
+class CountingResource : public std::pmr::memory_resource {
+   public:
+    std::atomic<size_t> allocations{0};
+    std::atomic<long long> outstanding{0};
+
+   private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations++;
+        outstanding += static_cast<long long>(bytes);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, size_t bytes,
+                       size_t alignment) override {
+        outstanding -= static_cast<long long>(bytes);
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+struct Large {
+    char bytes[256];
+    int id;
+};
+
+void test_channel_memory_resource() {
+    log("Testing channels allocating from a memory resource");
+    CountingResource resource;
+    {
+        // Queue slots, slab chunks and ring slots all come from the resource
+        UnboundedChannel<std::string> queue(0, &resource);
+        UnboundedChannel<Large> slab(0, &resource);
+        SpscChannel<int> ring(64, &resource);
+        size_t after_construction = resource.allocations;
+        assert(after_construction >= 1);  // The ring's slots
+
+        for (int i = 0; i < 1000; ++i) {
+            queue.send(std::to_string(i));
+            slab.send(Large{{}, i});
+        }
+        assert(resource.allocations > after_construction);
+        for (int i = 0; i < 1000; ++i) {
+            assert(*queue.receive() == std::to_string(i));
+            assert(slab.receive()->id == i);
+        }
+        ring.send(1);
+        assert(*ring.receive() == 1);
+    }
+    assert(resource.outstanding == 0 && "Leaked memory");
+
+    // The selector's channel list and callback state, and the channel's
+    // list of selectors
+    {
+        Channel<int> ch(4, &resource);
+        Selector selector(&resource);
+        size_t before = resource.allocations;
+        int sum = 0;
+        selector.add_receive<int>(ch, [&sum](int value) { sum += value; });
+        assert(resource.allocations > before);
+        ch.send(1);
+        ch.send(2);
+        ch.close();
+        selector.select();
+        assert(sum == 3);
+    }
+    assert(resource.outstanding == 0 && "Leaked memory");
+    log("Memory resource test completed");
+}
+
+void test_thread_pool_resource() {
+    log("Testing the per-thread pool resource");
+    constexpr int kPerProducer = 20000;
+    UnboundedChannel<std::string> ch(0, thread_pool_resource());
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; ++p) {
+        producers.emplace_back([&ch, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                ch.send(std::to_string(p * kPerProducer + i));
+            }
+        });
+    }
+    long long sum = 0;
+    std::thread consumer([&ch, &sum] {
+        // Frees chunks allocated by the producers
+        while (auto value = ch.receive()) {
+            sum += std::stoi(*value);
+        }
+    });
+    for (auto& t : producers) {
+        t.join();
+    }
+    ch.close();
+    consumer.join();
+    long long total = 3LL * kPerProducer;
+    assert(sum == total * (total - 1) / 2 && "Corrupted values");
+
+    // Blocks of all sizes round-trip, including ones that are not cached
+    std::pmr::memory_resource* pool = thread_pool_resource();
+    for (size_t bytes : {1, 16, 17, 100, 4096, 4097, 1 << 20}) {
+        void* block = pool->allocate(bytes, 8);
+        std::memset(block, 0xab, bytes);
+        pool->deallocate(block, bytes, 8);
+        // Cached blocks are reused by the same thread
+        void* again = pool->allocate(bytes, 8);
+        assert(again == block || bytes > 4096);
+        pool->deallocate(again, bytes, 8);
+    }
+    void* aligned = pool->allocate(64, 256);
+    assert(reinterpret_cast<uintptr_t>(aligned) % 256 == 0);
+    pool->deallocate(aligned, 64, 256);
+    log("Thread pool resource test completed");
+}
+
+void test_channel_arena() {
+    log("Testing channels built in an arena");
+    CountingResource upstream;
+    ChannelArena arena(1024, &upstream);
+    for (int request = 0; request < 3; ++request) {
+        {
+            Channel<std::string> requests(0, &arena);
+            UnboundedChannel<std::string> rows(0, &arena);
+            std::thread worker([&rows] {
+                for (int i = 0; i < 500; ++i) {
+                    rows.send("row " + std::to_string(i));
+                }
+                rows.close();
+            });
+            int count = 0;
+            while (rows.receive()) {
+                count++;
+            }
+            worker.join();
+            assert(count == 500);
+        }
+        // Tearing down the request releases everything at once
+        assert(upstream.outstanding > 0);
+        arena.release();
+        assert(upstream.outstanding == 0);
+    }
+    log("Arena test completed");
+}
+
+int main() {
+    log("Starting channel memory resource tests");
+
+    test_channel_memory_resource();
+    test_thread_pool_resource();
+    test_channel_arena();
+
+    log("All tests completed successfully");
+    return 0;
+}
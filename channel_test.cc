@@ -1,8 +1,11 @@
 #include "channel.h"
 
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <iostream>
+#include <limits>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -201,6 +204,644 @@ void test_multiple_producers_consumers() {
     log("Multiple producers and consumers test completed");
 }
 
+void test_unbuffered_repeated_exchange() {
+    log("Testing repeated exchanges on an unbuffered channel");
+    Channel<int> ch;
+
+    std::thread receiver([&ch] {
+        for (int i = 0; i < 100; ++i) {
+            assert(*ch.receive() == i && "Received out of order");
+        }
+    });
+    for (int i = 0; i < 100; ++i) {
+        ch.send(i);
+    }
+    receiver.join();
+
+    // With no receiver left, a send must block instead of slipping through
+    std::atomic<bool> sent(false);
+    std::thread sender([&ch, &sent] {
+        ch.send(100);
+        sent = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!sent && "Unbuffered send completed without a receiver");
+    assert(*ch.receive() == 100);
+    sender.join();
+
+    log("Unbuffered repeated exchange test completed");
+}
+
+// A value whose copy throws while fail is set; moving never throws
+struct ThrowingCopy {
+    struct CopyFailed {};
+    static std::atomic<bool> fail;
+
+    explicit ThrowingCopy(int id = 0) : id(id) {}
+    ThrowingCopy(const ThrowingCopy& other) : id(other.id) {
+        if (fail) {
+            throw CopyFailed();
+        }
+    }
+    ThrowingCopy(ThrowingCopy&&) noexcept = default;
+    ThrowingCopy& operator=(const ThrowingCopy&) = default;
+    ThrowingCopy& operator=(ThrowingCopy&&) noexcept = default;
+
+    int id;
+};
+std::atomic<bool> ThrowingCopy::fail{false};
+
+void test_unbuffered_throwing_copy() {
+    log("Testing unbuffered sends of values whose copy throws");
+    Channel<ThrowingCopy> ch;
+    static_assert(Channel<ThrowingCopy>::nothrow_receive);
+
+    // Receivers in the noexcept status receives pair with the sender
+    // through elimination; a failing copy must reach the sender
+    std::atomic<bool> done{false};
+    std::atomic<int> received{0};
+    std::thread receiver([&] {
+        ThrowingCopy out;
+        while (!done) {
+            if (ch.try_receive_status(out) == ChannelStatus::ok ||
+                ch.receive_status_for(out, std::chrono::milliseconds(1)) ==
+                    ChannelStatus::ok) {
+                assert(out.id == received);
+                ++received;
+            }
+        }
+    });
+    ThrowingCopy::fail = true;
+    for (int i = 0; i < 100; ++i) {
+        ThrowingCopy value(-1);
+        try {
+            ch.send(value);
+            assert(false && "Expected exception was not thrown");
+        } catch (const ThrowingCopy::CopyFailed&) {
+        }
+    }
+    ThrowingCopy::fail = false;
+    for (int i = 0; i < 100; ++i) {
+        ThrowingCopy value(i);
+        ch.send(value);
+    }
+    done = true;
+    receiver.join();
+    assert(received == 100);
+    log("Unbuffered throwing copy test completed");
+}
+
+void test_cancellation() {
+    log("Testing cancellation of blocked operations");
+    Channel<int> ch(1);
+    ch.send(1);
+
+    // A blocked sender on a full channel
+    CancellationToken send_token;
+    std::thread blocked_sender([&ch, &send_token] {
+        bool sent = ch.send(2, send_token);
+        assert(!sent && "Cancelled send should report failure");
+        log("Blocked send cancelled");
+    });
+
+    // A second sender on the same channel that must not be affected
+    std::thread other_sender([&ch] { ch.send(3); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto start = std::chrono::steady_clock::now();
+    send_token.cancel();
+    blocked_sender.join();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    log("Send cancelled after " + std::to_string(elapsed.count()) + "us");
+
+    assert(!ch.is_closed() && "Cancellation must not close the channel");
+    assert(*ch.receive() == 1);
+    other_sender.join();
+    assert(*ch.receive() == 3 && "Other sender should complete normally");
+
+    // A blocked receiver on an empty channel
+    CancellationToken recv_token;
+    auto future_recv = ch.async_receive(recv_token);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    recv_token.cancel();
+    assert(!future_recv.get() && "Cancelled receive should return nullopt");
+
+    // Already cancelled tokens fail immediately, even if the op could proceed
+    assert(!ch.send(4, send_token) && ch.is_empty());
+    assert(!ch.receive(recv_token));
+
+    // A fresh token does not interfere with normal operation
+    CancellationToken unused;
+    assert(ch.send(5, unused));
+    assert(*ch.receive(unused) == 5);
+
+    log("Cancellation test completed");
+}
+
+void test_unbuffered_cancellation() {
+    log("Testing cancellation on an unbuffered channel");
+    Channel<int> ch;
+
+    CancellationToken token;
+    auto future_recv = ch.async_receive(token);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    token.cancel();
+    assert(!future_recv.get());
+
+    // The cancelled receiver must not be counted as waiting anymore
+    CancellationToken send_token;
+    auto future_send = ch.async_send(1, send_token);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(ch.is_empty() && "Send paired with a cancelled receiver");
+    send_token.cancel();
+    assert(!future_send.get());
+
+    log("Unbuffered cancellation test completed");
+}
+
+template <typename Ch, typename V>
+void check_batch_transfer(Ch& ch, const std::vector<V>& input, size_t block) {
+    std::thread producer([&] {
+        // Send in uneven chunks so batches straddle the ring's wraparound
+        size_t offset = 0;
+        for (size_t chunk = 1; offset < input.size(); chunk = chunk * 3 + 1) {
+            size_t n = std::min(chunk, input.size() - offset);
+            ch.send_batch(input.data() + offset, n);
+            offset += n;
+        }
+        ch.close();
+    });
+    std::vector<V> output;
+    std::vector<V> buffer(block);
+    while (size_t n = ch.receive_batch(buffer.data(), buffer.size())) {
+        output.insert(output.end(), buffer.begin(), buffer.begin() + n);
+    }
+    producer.join();
+    assert(output == input && "Batch transfer lost or reordered values");
+}
+
+struct Sample {
+    int id;
+    double value;
+    bool operator==(const Sample& other) const {
+        return id == other.id && value == other.value;
+    }
+};
+
+void test_batch_operations() {
+    log("Testing batch operations");
+    std::vector<int> ints(10000);
+    for (int i = 0; i < 10000; ++i) {
+        ints[i] = i;
+    }
+
+    Channel<int> buffered(7);
+    check_batch_transfer(buffered, ints, 5);
+
+    Channel<int> unbuffered;
+    check_batch_transfer(unbuffered, std::vector<int>(ints.begin(),
+                                                      ints.begin() + 100), 4);
+
+    SpscChannel<int> spsc(64);
+    check_batch_transfer(spsc, ints, 100);
+
+    StaticChannel<Sample, 13> samples;
+    std::vector<Sample> structs;
+    for (int i = 0; i < 1000; ++i) {
+        structs.push_back({i, i * 0.5});
+    }
+    check_batch_transfer(samples, structs, 8);
+
+    MpscChannel<std::string> strings(5);
+    std::vector<std::string> words;
+    for (int i = 0; i < 500; ++i) {
+        words.push_back("word" + std::to_string(i));
+    }
+    check_batch_transfer(strings, words, 3);
+
+    // Large enough for the streaming copy path
+    std::vector<int> large(1 << 19);
+    for (size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<int>(i * 7);
+    }
+    SpscChannel<int> wide(large.size());
+    check_batch_transfer(wide, large, 1 << 16);
+
+    // Growable storage copies batches of trivially copyable values in two
+    // segments: wrapping around its 16 slots, then growing while wrapped
+    Channel<double> growing(1000);
+    std::vector<double> reals(40);
+    for (size_t i = 0; i < reals.size(); ++i) {
+        reals[i] = i * 0.25;
+    }
+    double got[40] = {};
+    growing.send_batch(reals.data(), 10);
+    assert(growing.receive_batch(got, 6) == 6);
+    growing.send_batch(reals.data() + 10, 10);
+    growing.send_batch(reals.data() + 20, 20);
+    for (size_t taken = 0; taken < 34;) {
+        taken += growing.try_receive_batch(got + taken, 40 - taken);
+    }
+    for (size_t i = 0; i < 34; ++i) {
+        assert(got[i] == reals[i + 6]);
+    }
+    assert(growing.is_empty());
+
+    // Non-blocking variants stop at the capacity and at the available values
+    Channel<int> small(3);
+    assert(small.try_send_batch(ints.data(), 5) == 3);
+    int out[5] = {};
+    assert(small.try_receive_batch(out, 5) == 3);
+    assert(out[0] == 0 && out[2] == 2);
+    assert(small.try_receive_batch(out, 5) == 0);
+    small.close();
+    assert(small.try_send_batch(ints.data(), 1) == 0);
+    assert(small.receive_batch(out, 5) == 0);
+    try {
+        small.send_batch(ints.data(), 1);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::runtime_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    log("Batch operations test completed");
+}
+
+struct LargeMessage {
+    std::string name;  // Non-trivial member, so slots must be destroyed
+    int payload[64];
+};
+
+void test_large_element_storage() {
+    log("Testing slab storage for large elements");
+    static_assert(std::is_same_v<detail::GrowableBuffer<LargeMessage>,
+                                 detail::SlabBuffer<LargeMessage>>);
+    static_assert(std::is_same_v<detail::GrowableBuffer<int>,
+                                 detail::QueueBuffer<int>>);
+
+    UnboundedChannel<LargeMessage> unbounded;
+    // Grow past one slab chunk, then keep cycling through recycled slots
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 200; ++i) {
+            LargeMessage message{"m" + std::to_string(i), {}};
+            message.payload[63] = i;
+            unbounded.send(message);
+        }
+        for (int i = 0; i < 150; ++i) {
+            auto message = unbounded.receive();
+            assert(message->name == "m" + std::to_string(i) &&
+                   message->payload[63] == i);
+        }
+        for (int i = 150; i < 200; ++i) {
+            assert(unbounded.receive()->payload[63] == i);
+        }
+        assert(unbounded.is_empty());
+    }
+    unbounded.send({"left behind", {}});  // Destroyed with the channel
+
+    Channel<LargeMessage> buffered(4);
+    std::thread producer([&buffered] {
+        for (int i = 0; i < 1000; ++i) {
+            buffered.send({std::to_string(i), {i}});
+        }
+        buffered.close();
+    });
+    int expected = 0;
+    while (auto message = buffered.receive()) {
+        assert(message->payload[0] == expected &&
+               message->name == std::to_string(expected));
+        expected++;
+    }
+    producer.join();
+    assert(expected == 1000);
+    log("Large element storage test completed");
+}
+
+template <typename Ch>
+void check_status_timeouts(Ch& ch) {
+    using namespace std::chrono_literals;
+    int value = 0;
+    assert(ch.receive_status_for(value, 20ms) == ChannelStatus::timeout);
+    assert(ch.send_status_for(1, 20ms) == ChannelStatus::ok);
+    assert(ch.send_status_for(2, 20ms) == ChannelStatus::timeout);
+    assert(ch.receive_status_for(value, 20ms) == ChannelStatus::ok &&
+           value == 1);
+}
+
+void test_status_operations() {
+    log("Testing status-returning operations");
+    using namespace std::chrono_literals;
+
+    Channel<int> ch(1);
+    int value = 0;
+    assert(ch.try_receive_status(value) == ChannelStatus::empty);
+    assert(ch.try_send_status(1) == ChannelStatus::ok);
+    assert(ch.try_send_status(2) == ChannelStatus::full);
+    assert(ch.receive_status(value) == ChannelStatus::ok && value == 1);
+
+    check_status_timeouts(ch);
+    SpscChannel<int> spsc(1);
+    check_status_timeouts(spsc);
+    SpscChannel<int, channel_policy::spin> spinning(1);
+    check_status_timeouts(spinning);
+
+    // An unbuffered send times out without a receiver
+    Channel<int> unbuffered;
+    assert(unbuffered.send_status_for(1, 20ms) == ChannelStatus::timeout);
+    assert(unbuffered.receive_status_for(value, 20ms) ==
+           ChannelStatus::timeout);
+
+    CancellationToken token;
+    token.cancel();
+    assert(ch.receive_status(value, token) == ChannelStatus::cancelled);
+    ch.send(3);
+    assert(ch.send_status(4, token) == ChannelStatus::cancelled);
+
+    // Values sent before close() are still received, then closed is reported
+    ch.close();
+    assert(ch.send_status(5) == ChannelStatus::closed);
+    assert(ch.try_send_status(5) == ChannelStatus::closed);
+    assert(ch.receive_status(value) == ChannelStatus::ok && value == 3);
+    assert(ch.receive_status(value) == ChannelStatus::closed && value == 3);
+    assert(ch.try_receive_status(value) == ChannelStatus::closed);
+
+    // A blocked sender is released with a status when the channel closes
+    Channel<int> blocked(1);
+    blocked.send(1);
+    auto sender = std::async(std::launch::async,
+                             [&blocked] { return blocked.send_status(2); });
+    std::this_thread::sleep_for(20ms);
+    blocked.close();
+    assert(sender.get() == ChannelStatus::closed);
+
+    static_assert(noexcept(spsc.send_status(1)));
+    static_assert(noexcept(ch.receive_status(value)));
+    static_assert(!noexcept(ch.send_status(1)));  // The queue may allocate
+    log("Status operations test completed");
+}
+
+void test_huge_page_storage() {
+    log("Testing huge page backed and prefaulted ring storage");
+    StorageOptions options;
+    options.huge_pages = true;
+    options.prefault = true;
+
+    // Rounded up to whole huge pages, aligned to them, and already zeroed
+    detail::MappedMemory memory(3 << 20, options);
+    assert(memory.size() == size_t(4) << 20);
+    assert(reinterpret_cast<uintptr_t>(memory.data()) %
+               detail::kHugePageSize ==
+           0);
+    auto* bytes = static_cast<unsigned char*>(memory.data());
+    assert(bytes[0] == 0 && bytes[memory.size() - 1] == 0);
+    switch (memory.page_backing()) {
+        case PageBacking::hugetlb:
+            log("Backed by reserved huge pages");
+            break;
+        case PageBacking::transparent_huge:
+            log("Backed by transparent huge pages");
+            break;
+        case PageBacking::regular:
+            log("Huge pages unavailable, using base pages");
+            break;
+    }
+
+    // A channel over such storage behaves like any other ring
+    SpscChannel<std::string> ch(1 << 16, options);
+    std::thread producer([&ch] {
+        for (int i = 0; i < 100000; ++i) {
+            ch.send(std::to_string(i));
+        }
+        ch.close();
+    });
+    int expected = 0;
+    while (auto value = ch.receive()) {
+        assert(*value == std::to_string(expected));
+        expected++;
+    }
+    producer.join();
+    assert(expected == 100000);
+
+    // Prefault alone maps base pages
+    StorageOptions prefault_only;
+    prefault_only.prefault = true;
+    detail::MappedMemory small(100, prefault_only);
+    assert(small.page_backing() == PageBacking::regular);
+    log("Huge page storage test completed");
+}
+
+struct NoDefault {
+    explicit NoDefault(int id) : id(id) {}
+    int id;
+};
+
+void test_range_iteration() {
+    log("Testing range-based iteration");
+    Channel<std::string> ch(8);
+    std::thread producer([&ch] {
+        for (int i = 0; i < 1000; ++i) {
+            ch.send(std::to_string(i));
+        }
+        ch.close();
+    });
+    int expected = 0;
+    for (auto&& value : ch) {
+        assert(value == std::to_string(expected++));
+    }
+    producer.join();
+    assert(expected == 1000);
+
+    // drain() on the lock-free ring, taking larger batches
+    SpscChannel<int> ring(64);
+    std::thread ring_producer([&ring] {
+        for (int i = 0; i < 10000; ++i) {
+            ring.send(i);
+        }
+        ring.close();
+    });
+    expected = 0;
+    for (int value : ring.drain(256)) {
+        assert(value == expected++);
+    }
+    ring_producer.join();
+    assert(expected == 10000);
+
+    // A closed, empty channel yields nothing
+    for ([[maybe_unused]] int value : ring) {
+        assert(false);
+    }
+
+    // Values that cannot be received in batches are taken one at a time
+    Channel<NoDefault> single(4);
+    single.send(NoDefault(1));
+    single.send(NoDefault(2));
+    single.close();
+    int sum = 0;
+    for (auto& value : single.drain()) {
+        sum += value.id;
+    }
+    assert(sum == 3);
+
+    // Plain iteration and drain(1) leave the rest queued when the loop stops
+    // early
+    Channel<int> partial(4);
+    partial.send(1);
+    partial.send(2);
+    partial.send(3);
+    for (int value : partial) {
+        assert(value == 1);
+        break;
+    }
+    assert(partial.size() == 2);
+    try {
+        for (int value : partial) {
+            assert(value == 2);
+            throw std::runtime_error("stop");
+        }
+    } catch (const std::runtime_error&) {
+    }
+    assert(partial.size() == 1);
+    for (int value : partial.drain(1)) {
+        assert(value == 3);
+        break;
+    }
+    assert(partial.is_empty());
+    log("Range iteration test completed");
+}
+
+// Copies and moves stall while stall is set, so a test can hold a channel's
+// lock from inside a push or pop
+struct Stall {
+    static std::atomic<bool> stall;
+    static std::atomic<bool> stalled;
+
+    Stall() = default;
+    Stall(const Stall&) { wait(); }
+    Stall(Stall&&) noexcept { wait(); }
+    Stall& operator=(const Stall&) = default;
+    Stall& operator=(Stall&&) = default;
+
+    static void wait() {
+        if (stall) {
+            stalled = true;
+            while (stall) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    static void hold() {
+        stalled = false;
+        stall = true;
+    }
+};
+std::atomic<bool> Stall::stall{false};
+std::atomic<bool> Stall::stalled{false};
+
+void test_lock_free_queries() {
+    log("Testing queries and failing try operations without the lock");
+    Channel<Stall> ch(1);
+    Stall value;
+
+    // A sender holds the lock while pushing into the empty channel
+    Stall::hold();
+    std::thread sender([&ch] { ch.send(Stall()); });
+    while (!Stall::stalled) {
+        std::this_thread::yield();
+    }
+    assert(ch.is_empty() && ch.size() == 0 && !ch.is_closed());
+    assert(!ch.try_receive());
+    assert(ch.try_receive_batch(&value, 1) == 0);
+    Stall::stall = false;
+    sender.join();
+
+    // A receiver holds the lock while popping from the full channel
+    Stall::hold();
+    std::thread receiver([&ch] { assert(ch.receive()); });
+    while (!Stall::stalled) {
+        std::this_thread::yield();
+    }
+    assert(!ch.is_empty() && ch.size() == 1);
+    assert(ch.try_send_status(Stall()) == ChannelStatus::full);
+    assert(ch.try_send_batch(&value, 1) == 0);
+    Stall::stall = false;
+    receiver.join();
+
+    ch.close();
+    assert(ch.is_closed());
+    assert(ch.try_receive_status(value) == ChannelStatus::closed);
+    assert(ch.try_send_status(value) == ChannelStatus::closed);
+
+    // A shared ring holding at most one value while pushes and pops race the
+    // unlocked check must never be reported full
+    using namespace channel_policy;
+    Channel<int, ChannelPolicy<multi, multi, bounded_ring>> ring(2);
+    std::atomic<bool> done{false};
+    std::thread churn([&ring, &done] {
+        while (!done) {
+            ring.send(1);
+            ring.receive();
+        }
+    });
+    for (int i = 0; i < 100000; ++i) {
+        // churn holds at most one value, so there is room for ours
+        assert(ring.try_send_status(2) == ChannelStatus::ok &&
+               "Spurious full on a ring with free slots");
+        ring.receive();
+    }
+    done = true;
+    churn.join();
+    log("Lock-free query test completed");
+}
+
+void test_large_capacities() {
+    log("Testing channels with very large capacities");
+    // The bound only limits how far senders may run ahead; the buffer grows
+    // with the values actually queued
+    for (size_t cap : {std::numeric_limits<size_t>::max(), size_t(1) << 40}) {
+        Channel<int> ch(cap);
+        for (int i = 0; i < 100; ++i) {
+            assert(ch.try_send(i));
+        }
+        for (int i = 0; i < 100; ++i) {
+            assert(*ch.receive() == i);
+        }
+        Channel<LargeMessage> slab(cap);
+        slab.send({"large", {7}});
+        assert(slab.receive()->payload[0] == 7);
+    }
+
+    // Preallocating a capacity that cannot be addressed fails up front
+    try {
+        Channel<int> ch(std::numeric_limits<size_t>::max(),
+                        StorageOptions::preallocated());
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::length_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    try {
+        Channel<LargeMessage> ch(size_t(1) << 40,
+                                 StorageOptions::preallocated());
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::length_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+
+    // A ring whose slots would take more bytes than a size_t can count
+    using namespace channel_policy;
+    try {
+        Channel<long long, ChannelPolicy<multi, multi, bounded_ring>> ring(
+            std::numeric_limits<size_t>::max() / 8 + 3);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::length_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+
+    Channel<int> reserved(1000, StorageOptions::preallocated());
+    assert(reserved.try_send(1) && *reserved.receive() == 1);
+    log("Large capacity test completed");
+}
+
 int main() {
     log("Starting Channel tests");
 
@@ -210,6 +851,17 @@ int main() {
     test_try_operations();
     test_close_operations();
     test_multiple_producers_consumers();
+    test_unbuffered_repeated_exchange();
+    test_unbuffered_throwing_copy();
+    test_cancellation();
+    test_unbuffered_cancellation();
+    test_batch_operations();
+    test_large_element_storage();
+    test_status_operations();
+    test_huge_page_storage();
+    test_range_iteration();
+    test_lock_free_queries();
+    test_large_capacities();
 
     log("All tests completed successfully");
     return 0;
@@ -0,0 +1,124 @@
+#include "coalescing_channel.h"
+
+template <typename Key, typename Value, typename Hash>
+void CoalescingChannel<Key, Value, Hash>::send(const Key& key,
+                                               const Value& value) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (closed) {
+        throw std::runtime_error("Send on closed channel");
+    }
+    if (merge_locked(key, value)) {
+        return;
+    }
+    // Wait until there's room for another key, the key got a slot from
+    // another sender in the meantime, or the channel is closed
+    cv_send.wait(lock, [this, &key] {
+        return !full_locked() || index.count(key) != 0 || closed;
+    });
+    if (closed) {
+        throw std::runtime_error("Channel closed while waiting to send");
+    }
+    if (!merge_locked(key, value)) {
+        append_locked(key, value);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+bool CoalescingChannel<Key, Value, Hash>::try_send(const Key& key,
+                                                   const Value& value) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (closed) {
+        return false;
+    }
+    if (merge_locked(key, value)) {
+        return true;
+    }
+    if (full_locked()) {
+        return false;
+    }
+    append_locked(key, value);
+    return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::optional<typename CoalescingChannel<Key, Value, Hash>::Entry>
+CoalescingChannel<Key, Value, Hash>::receive() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv_recv.wait(lock, [this] { return !slots.empty() || closed; });
+    if (slots.empty()) {
+        return std::nullopt;  // Closed and empty
+    }
+    Entry entry = pop_locked();
+    cv_send.notify_one();  // Notify a waiting sender
+    return entry;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::optional<typename CoalescingChannel<Key, Value, Hash>::Entry>
+CoalescingChannel<Key, Value, Hash>::try_receive() {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (slots.empty()) {
+        return std::nullopt;
+    }
+    Entry entry = pop_locked();
+    cv_send.notify_one();  // Notify a waiting sender
+    return entry;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::vector<typename CoalescingChannel<Key, Value, Hash>::Entry>
+CoalescingChannel<Key, Value, Hash>::drain() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv_recv.wait(lock, [this] { return !slots.empty() || closed; });
+    std::vector<Entry> entries;
+    entries.reserve(slots.size());
+    while (!slots.empty()) {
+        entries.push_back(pop_locked());
+    }
+    cv_send.notify_all();  // Every slot is free again
+    return entries;
+}
+
+template <typename Key, typename Value, typename Hash>
+void CoalescingChannel<Key, Value, Hash>::close() {
+    std::unique_lock<std::mutex> lock(mtx);
+    closed = true;
+    cv_send.notify_all();  // Notify all waiting senders
+    cv_recv.notify_all();  // Notify all waiting receivers
+}
+
+template <typename Key, typename Value, typename Hash>
+bool CoalescingChannel<Key, Value, Hash>::merge_locked(const Key& key,
+                                                       const Value& value) {
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return false;
+    }
+    Slot& slot = slots[it->second - head_seq];
+    if (reducer) {
+        slot.value = reducer(std::move(slot.value), value);
+    } else {
+        slot.value = value;
+    }
+    ++coalesced_count;
+    return true;
+}
+
+template <typename Key, typename Value, typename Hash>
+void CoalescingChannel<Key, Value, Hash>::append_locked(const Key& key,
+                                                        const Value& value) {
+    index.emplace(key, head_seq + slots.size());
+    slots.push_back({key, value});
+    cv_recv.notify_one();  // Notify a waiting receiver
+}
+
+template <typename Key, typename Value, typename Hash>
+typename CoalescingChannel<Key, Value, Hash>::Entry
+CoalescingChannel<Key, Value, Hash>::pop_locked() {
+    Slot& slot = slots.front();
+    index.erase(slot.key);
+    Entry entry(std::move(slot.key), std::move(slot.value));
+    slots.pop_front();
+    ++head_seq;
+    return entry;
+}
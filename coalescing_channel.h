@@ -0,0 +1,188 @@
+#ifndef COALESCING_CHANNEL_H
+#define COALESCING_CHANNEL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A keyed channel that merges pending updates for the same key.
+ *
+ * While an update for a key is waiting to be received, further updates for
+ * that key do not take a new slot. They are combined with the pending one by
+ * a user-supplied reducer (by default the newer value replaces the older one).
+ * Keys are delivered in the order of their first pending update, and each key
+ * is handed out at most once per drain, which bounds downstream work under
+ * hot-key storms by the number of distinct keys.
+ *
+ * @tparam Key The type of the keys.
+ * @tparam Value The type of the values.
+ * @tparam Hash The hash function for the key index.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class CoalescingChannel {
+   public:
+    using Entry = std::pair<Key, Value>;
+    using Reducer = std::function<Value(Value pending, const Value& incoming)>;
+
+    /**
+     * @brief Constructs a CoalescingChannel object.
+     * @param cap The maximum number of distinct pending keys. If 0, the
+     * number of pending keys is unbounded. Updates to a key that is already
+     * pending never block.
+     * @param reducer Merges a pending value with an incoming one. If empty,
+     * the incoming value replaces the pending one.
+     *
+     * Use Case: Cache invalidation streams where only the latest state of a
+     * key matters.
+     * Example: CoalescingChannel<std::string, Version> ch(
+     *              1024, [](Version a, const Version& b) {
+     *                  return std::max(a, b);
+     *              });
+     */
+    CoalescingChannel(size_t cap = 0, Reducer reducer = nullptr)
+        : capacity(cap), reducer(std::move(reducer)) {}
+
+    // Disable copying and moving
+    CoalescingChannel(const CoalescingChannel&) = delete;
+    CoalescingChannel& operator=(const CoalescingChannel&) = delete;
+    CoalescingChannel(CoalescingChannel&&) = delete;
+    CoalescingChannel& operator=(CoalescingChannel&&) = delete;
+
+    // Destructor
+    ~CoalescingChannel() { close(); }
+
+    /**
+     * @brief Sends an update for a key. If an update for the key is pending,
+     * it is merged with the new value; otherwise a new slot is appended,
+     * blocking while the channel holds the maximum number of keys.
+     * @param key The key of the update.
+     * @param value The value of the update.
+     * @throws std::runtime_error if the channel is closed.
+     *
+     * Example: ch.send("user:42", version);
+     */
+    void send(const Key& key, const Value& value);
+
+    /**
+     * @brief Attempts to send an update without blocking.
+     * @return true if the update was stored or merged, false if the channel
+     * is full of other keys or closed.
+     */
+    bool try_send(const Key& key, const Value& value);
+
+    /**
+     * @brief Receives the oldest pending key with its merged value. Blocks if
+     * the channel is empty.
+     * @return The key and value, or std::nullopt if the channel is closed and
+     * empty.
+     */
+    std::optional<Entry> receive();
+
+    /**
+     * @brief Attempts to receive the oldest pending key without blocking.
+     * @return The key and value, or std::nullopt if the channel is empty.
+     */
+    std::optional<Entry> try_receive();
+
+    /**
+     * @brief Takes every pending key at once. Blocks until at least one key
+     * is pending or the channel is closed.
+     * @return All pending entries in arrival order (each key at most once),
+     * or an empty vector if the channel is closed and empty.
+     *
+     * Use Case: Process a whole burst of invalidations under one lock.
+     * Example: for (auto& [key, value] : ch.drain()) { invalidate(key); }
+     */
+    std::vector<Entry> drain();
+
+    /**
+     * @brief Closes the channel. No more updates can be sent after closing.
+     */
+    void close();
+
+    /**
+     * @brief Checks if the channel is closed.
+     */
+    bool is_closed() const {
+        std::unique_lock<std::mutex> lock(mtx);
+        return closed;
+    }
+
+    /**
+     * @brief Checks if no key is pending.
+     */
+    bool is_empty() const {
+        std::unique_lock<std::mutex> lock(mtx);
+        return index.empty();
+    }
+
+    /**
+     * @brief Returns the number of distinct pending keys.
+     */
+    size_t size() const {
+        std::unique_lock<std::mutex> lock(mtx);
+        return index.size();
+    }
+
+    /**
+     * @brief Returns how many updates were merged into a pending key instead
+     * of taking a slot of their own.
+     */
+    uint64_t coalesced() const {
+        std::unique_lock<std::mutex> lock(mtx);
+        return coalesced_count;
+    }
+
+   private:
+    struct Slot {
+        Key key;
+        Value value;
+    };
+
+    /**
+     * @brief Merges into a pending slot if the key has one. Must be called
+     * with mtx held.
+     * @return true if the update was merged.
+     */
+    bool merge_locked(const Key& key, const Value& value);
+
+    /**
+     * @brief Appends a new slot. Must be called with mtx held.
+     */
+    void append_locked(const Key& key, const Value& value);
+
+    /**
+     * @brief Pops the oldest pending slot. Must be called with mtx held and
+     * at least one key pending.
+     */
+    Entry pop_locked();
+
+    bool full_locked() const {
+        return capacity != 0 && index.size() >= capacity;
+    }
+
+    // Slots are addressed by sequence number; the front of the deque holds
+    // sequence head_seq, so a key's slot is slots[index[key] - head_seq].
+    std::deque<Slot> slots;
+    std::unordered_map<Key, uint64_t, Hash> index;
+    uint64_t head_seq = 0;
+
+    mutable std::mutex mtx;
+    std::condition_variable cv_send, cv_recv;
+    bool closed = false;
+    size_t capacity;
+    Reducer reducer;
+    uint64_t coalesced_count = 0;
+};
+
+#include "coalescing_channel.cc"
+
+#endif  // COALESCING_CHANNEL_H
@@ -0,0 +1,137 @@
+#include "coalescing_channel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+void test_replace_pending() {
+    log("Testing replacement of pending updates");
+    CoalescingChannel<std::string, int> ch;
+
+    ch.send("a", 1);
+    ch.send("b", 1);
+    ch.send("a", 2);
+    ch.send("a", 3);
+
+    assert(ch.size() == 2 && "Expected two distinct pending keys");
+    assert(ch.coalesced() == 2 && "Expected two merged updates");
+
+    auto first = ch.receive();
+    assert(first && first->first == "a" && first->second == 3 &&
+           "Key a should keep its position and latest value");
+    auto second = ch.receive();
+    assert(second && second->first == "b" && second->second == 1);
+    assert(!ch.try_receive() && "Channel should be empty");
+
+    // Once received, the next update for a key takes a new slot
+    ch.send("a", 4);
+    assert(ch.size() == 1 && ch.try_receive()->second == 4);
+    log("Replacement test completed");
+}
+
+void test_reducer() {
+    log("Testing user-supplied reducer");
+    CoalescingChannel<int, int> ch(
+        0, [](int pending, const int& incoming) { return pending + incoming; });
+
+    for (int i = 1; i <= 10; ++i) {
+        ch.send(i % 2, i);
+    }
+    auto entries = ch.drain();
+    assert(entries.size() == 2 && "Drain should return each key once");
+    assert(entries[0].first == 1 && entries[0].second == 1 + 3 + 5 + 7 + 9);
+    assert(entries[1].first == 0 && entries[1].second == 2 + 4 + 6 + 8 + 10);
+    assert(ch.is_empty() && "Channel should be empty after drain");
+    log("Reducer test completed");
+}
+
+void test_capacity_and_close() {
+    log("Testing key capacity and close");
+    CoalescingChannel<int, int> ch(2);
+
+    assert(ch.try_send(1, 1) && ch.try_send(2, 1));
+    assert(!ch.try_send(3, 1) && "Third key should not fit");
+    assert(ch.try_send(1, 2) && "Updates to pending keys never block");
+
+    std::thread blocker([&ch] {
+        ch.send(3, 1);  // Blocks until a key is received
+        log("Sent key 3 after a slot was freed");
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(ch.receive()->first == 1);
+    blocker.join();
+
+    ch.close();
+    try {
+        ch.send(4, 1);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::runtime_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    assert(ch.receive()->first == 2);
+    assert(ch.receive()->first == 3);
+    assert(!ch.receive() && "Closed and empty channel should return nullopt");
+    assert(ch.drain().empty());
+    log("Capacity and close test completed");
+}
+
+void test_hot_key_storm() {
+    log("Testing hot-key storm with a busy consumer");
+    CoalescingChannel<int, int> ch(
+        0, [](int pending, const int& incoming) {
+            return std::max(pending, incoming);
+        });
+    const int updates = 100000;
+    const int keys = 8;
+
+    std::thread producer([&ch] {
+        for (int i = 0; i < updates; ++i) {
+            ch.send(i % keys, i);
+        }
+        ch.close();
+    });
+
+    std::vector<int> latest(keys, -1);
+    int processed = 0;
+    while (true) {
+        auto entries = ch.drain();
+        if (entries.empty()) {
+            break;
+        }
+        for (auto& [key, value] : entries) {
+            assert(value > latest[key] && "Versions must only move forward");
+            latest[key] = value;
+            processed++;
+        }
+    }
+    producer.join();
+
+    for (int k = 0; k < keys; ++k) {
+        assert(latest[k] == updates - keys + k && "Lost the final update");
+    }
+    log("Processed " + std::to_string(processed) + " entries for " +
+        std::to_string(updates) + " updates");
+    log("Hot-key storm test completed");
+}
+
+int main() {
+    log("Starting CoalescingChannel tests");
+
+    test_replace_pending();
+    test_reducer();
+    test_capacity_and_close();
+    test_hot_key_storm();
+
+    log("All tests completed successfully");
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include "combining_channel.h"
+
+template <typename T>
+CombiningChannel<T>::CombiningChannel(size_t capacity,
+                                      const StorageOptions& options)
+    : ring(capacity == 0 ? 1 : capacity, options), slots(new Slot[kSlots]) {
+    if (capacity == 0) {
+        throw std::invalid_argument(
+            "A combining channel needs a capacity greater than 0");
+    }
+}
+
+template <typename T>
+void CombiningChannel<T>::send(const T& value) {
+    if (send_status(value) == ChannelStatus::closed) {
+        throw std::runtime_error("Send on closed channel");
+    }
+}
+
+template <typename T>
+void CombiningChannel<T>::send(T&& value) {
+    if (send_status(std::move(value)) == ChannelStatus::closed) {
+        throw std::runtime_error("Send on closed channel");
+    }
+}
+
+template <typename T>
+ChannelStatus CombiningChannel<T>::send_status(const T& value) {
+    return execute(Op::send, &value, nullptr, nullptr);
+}
+
+template <typename T>
+ChannelStatus CombiningChannel<T>::send_status(T&& value) {
+    return execute(Op::send, nullptr, &value, nullptr);
+}
+
+template <typename T>
+bool CombiningChannel<T>::try_send(const T& value) {
+    return try_send_status(value) == ChannelStatus::ok;
+}
+
+template <typename T>
+ChannelStatus CombiningChannel<T>::try_send_status(const T& value) {
+    return execute(Op::try_send, &value, nullptr, nullptr);
+}
+
+template <typename T>
+std::optional<T> CombiningChannel<T>::receive() {
+    std::optional<T> result;
+    execute(Op::receive, nullptr, nullptr, &result);
+    return result;
+}
+
+template <typename T>
+std::optional<T> CombiningChannel<T>::try_receive() {
+    std::optional<T> result;
+    execute(Op::try_receive, nullptr, nullptr, &result);
+    return result;
+}
+
+template <typename T>
+void CombiningChannel<T>::close() {
+    std::unique_lock<std::mutex> lock(combinerMtx);
+    closed.store(true, std::memory_order_release);
+    // Fails the blocked senders and the receivers left with nothing to take
+    combine();
+}
+
+template <typename T>
+ChannelStatus CombiningChannel<T>::execute(Op op, const T* copy_from,
+                                           T* move_from,
+                                           std::optional<T>* out) {
+    // Tries for the combiner lock this many times before blocking on it
+    constexpr unsigned kSpinsBeforeLock = 16;
+
+    Slot& slot = claim_slot();
+    slot.op = op;
+    slot.copy_from = copy_from;
+    slot.move_from = move_from;
+    slot.out = out;
+    slot.state.store(pending, std::memory_order_release);
+
+    detail::Backoff backoff;
+    for (unsigned spins = 0;
+         slot.state.load(std::memory_order_acquire) != done;) {
+        if (++spins < kSpinsBeforeLock) {
+            if (!combinerMtx.try_lock()) {
+                backoff.pause();  // Another thread may be combining for us
+                continue;
+            }
+        } else {
+            combinerMtx.lock();
+        }
+        combine();
+        combinerMtx.unlock();
+        if (slot.state.load(std::memory_order_acquire) == done) {
+            break;
+        }
+        // The ring is full or empty for us. Every later combiner sees our
+        // slot, so sleep until one of them completes the operation.
+        std::unique_lock<std::mutex> lock(slot.mtx);
+        slot.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        slot.cv.wait(lock, [&slot] {
+            return slot.state.load(std::memory_order_acquire) == done;
+        });
+        slot.sleeping.store(false, std::memory_order_relaxed);
+    }
+
+    ChannelStatus status = slot.status;
+    std::exception_ptr error = std::move(slot.error);
+    slot.error = nullptr;
+    slot.state.store(idle, std::memory_order_release);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return status;
+}
+
+template <typename T>
+typename CombiningChannel<T>::Slot& CombiningChannel<T>::claim_slot() {
+    size_t start = detail::thread_index() % kSlots;
+    detail::Backoff backoff;
+    for (;;) {
+        for (size_t n = 0; n < kSlots; ++n) {
+            size_t i = (start + n) % kSlots;
+            Slot& slot = slots[i];
+            uint8_t expected = idle;
+            if (slot.state.load(std::memory_order_relaxed) == idle &&
+                slot.state.compare_exchange_strong(
+                    expected, claimed, std::memory_order_acquire)) {
+                size_t used = slotsInUse.load(std::memory_order_relaxed);
+                while (used <= i && !slotsInUse.compare_exchange_weak(
+                                        used, i + 1,
+                                        std::memory_order_release)) {
+                }
+                return slot;
+            }
+        }
+        backoff.pause();  // More threads than slots
+    }
+}
+
+template <typename T>
+void CombiningChannel<T>::combine() {
+    // A receive can make room for a send scanned earlier and vice versa, so
+    // keep going until nothing changes
+    for (bool progress = true; progress;) {
+        progress = false;
+        size_t used = slotsInUse.load(std::memory_order_acquire);
+        for (size_t i = 0; i < used; ++i) {
+            Slot& slot = slots[i];
+            if (slot.state.load(std::memory_order_acquire) == pending &&
+                apply(slot)) {
+                progress = true;
+            }
+        }
+    }
+}
+
+template <typename T>
+bool CombiningChannel<T>::apply(Slot& slot) {
+    bool is_closed = closed.load(std::memory_order_relaxed);
+    try {
+        switch (slot.op) {
+            case Op::send:
+            case Op::try_send:
+                if (is_closed) {
+                    complete(slot, ChannelStatus::closed);
+                } else if (ring.full()) {
+                    if (slot.op == Op::send) {
+                        return false;  // Stays pending until a receive
+                    }
+                    complete(slot, ChannelStatus::full);
+                } else {
+                    if (slot.move_from) {
+                        ring.push(std::move(*slot.move_from));
+                    } else {
+                        ring.push(*slot.copy_from);
+                    }
+                    complete(slot, ChannelStatus::ok);
+                }
+                return true;
+            case Op::receive:
+            case Op::try_receive:
+                if (!ring.empty()) {
+                    slot.out->emplace(ring.pop());
+                    complete(slot, ChannelStatus::ok);
+                } else if (is_closed) {
+                    complete(slot, ChannelStatus::closed);
+                } else if (slot.op == Op::try_receive) {
+                    complete(slot, ChannelStatus::empty);
+                } else {
+                    return false;  // Stays pending until a send
+                }
+                return true;
+        }
+    } catch (...) {
+        // The copy or move of the slot's owner threw; it rethrows
+        slot.error = std::current_exception();
+        complete(slot, ChannelStatus::ok);
+    }
+    return true;
+}
+
+template <typename T>
+void CombiningChannel<T>::complete(Slot& slot, ChannelStatus status) {
+    slot.status = status;
+    slot.state.store(done, std::memory_order_release);
+    // Pairs with the fence of a thread going to sleep: either it sees done,
+    // or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (slot.sleeping.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> lock(slot.mtx);
+        slot.cv.notify_one();
+    }
+}
@@ -0,0 +1,181 @@
+#ifndef COMBINING_CHANNEL_H
+#define COMBINING_CHANNEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+
+#include "channel.h"
+
+/**
+ * @brief A bounded multi-producer, multi-consumer channel built on flat
+ * combining, for channels shared by many threads.
+ *
+ * A thread does not touch the ring itself. It publishes its send or receive
+ * in a publication slot and tries to become the combiner. The combiner
+ * applies the pending operations of every slot to the ring in one pass, and
+ * repeats while a pass makes progress, so a burst of sends and receives
+ * costs one lock handover instead of one per operation, and the ring and
+ * its counters stay in the combiner's cache. The other threads spin on
+ * their own slot until their operation is done, and sleep on the slot's
+ * condition variable if it cannot complete yet (full or empty ring).
+ *
+ * Under light contention this is slower than Channel: every operation goes
+ * through a slot and waits for a combiner. It pays off when dozens of
+ * threads hit one channel. Values of one sender arrive in order.
+ *
+ * @tparam T The type of the values. The combiner runs other threads' copies
+ * and moves; an exception thrown by one is rethrown in the thread whose
+ * operation it was.
+ */
+template <typename T>
+class CombiningChannel {
+   public:
+    // Publication slots; more concurrent threads than this wait for a slot
+    static constexpr size_t kSlots = 128;
+
+    /**
+     * @brief Constructs a CombiningChannel object.
+     * @param capacity The capacity of the ring. Must be greater than 0.
+     * @param options Where and how to map the ring.
+     * @throws std::invalid_argument if capacity is 0.
+     *
+     * Use Case: A work queue shared by a large thread pool.
+     * Example: CombiningChannel<Task> tasks(4096);
+     */
+    explicit CombiningChannel(size_t capacity,
+                              const StorageOptions& options = {});
+
+    // Disable copying and moving
+    CombiningChannel(const CombiningChannel&) = delete;
+    CombiningChannel& operator=(const CombiningChannel&) = delete;
+    CombiningChannel(CombiningChannel&&) = delete;
+    CombiningChannel& operator=(CombiningChannel&&) = delete;
+
+    // Destructor
+    ~CombiningChannel() { close(); }
+
+    /**
+     * @brief Sends a value. Blocks while the channel is full.
+     * @param value The value to send.
+     * @throws std::runtime_error if the channel is closed.
+     *
+     * Example: tasks.send(task);
+     */
+    void send(const T& value);
+    void send(T&& value);
+
+    /**
+     * @brief Sends a value, reporting a closed channel instead of throwing.
+     * @return ChannelStatus::ok or closed.
+     */
+    ChannelStatus send_status(const T& value);
+    ChannelStatus send_status(T&& value);
+
+    /**
+     * @brief Attempts to send a value without blocking.
+     * @return true if the value was sent, false if the channel is full or
+     * closed.
+     */
+    bool try_send(const T& value);
+
+    /**
+     * @brief Attempts to send a value without blocking.
+     * @return ChannelStatus::ok, full or closed.
+     */
+    ChannelStatus try_send_status(const T& value);
+
+    /**
+     * @brief Receives a value. Blocks while the channel is empty.
+     * @return The value, or std::nullopt if the channel is closed and empty.
+     *
+     * Example: while (auto task = tasks.receive()) { run(*task); }
+     */
+    std::optional<T> receive();
+
+    /**
+     * @brief Attempts to receive a value without blocking.
+     * @return The value, or std::nullopt if the channel is empty.
+     */
+    std::optional<T> try_receive();
+
+    /**
+     * @brief Closes the channel. Blocked senders fail, blocked receivers
+     * drain the remaining values and then return std::nullopt.
+     */
+    void close();
+
+    bool is_closed() const { return closed.load(std::memory_order_acquire); }
+    bool is_empty() const { return ring.empty(); }
+    size_t size() const { return ring.size(); }
+    size_t capacity() const { return ring.capacity(); }
+
+   private:
+    enum class Op : uint8_t { send, try_send, receive, try_receive };
+
+    // The state of a slot. A thread claims an idle slot, fills it in and
+    // publishes it as pending; the combiner stores the outcome.
+    enum State : uint8_t { idle, claimed, pending, done };
+
+    /**
+     * @brief A publication slot, on its own cache lines.
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint8_t> state{idle};
+        std::atomic<bool> sleeping{false};
+        Op op = Op::send;
+        const T* copy_from = nullptr;  // Send by copy
+        T* move_from = nullptr;        // Send by move
+        std::optional<T>* out = nullptr;
+        ChannelStatus status = ChannelStatus::ok;
+        std::exception_ptr error;
+        std::mutex mtx;
+        std::condition_variable cv;
+    };
+
+    /**
+     * @brief Publishes an operation and waits until it is done.
+     * @return The outcome of the operation.
+     */
+    ChannelStatus execute(Op op, const T* copy_from, T* move_from,
+                          std::optional<T>* out);
+
+    /**
+     * @brief Claims an idle slot, preferring the one of the calling thread.
+     */
+    Slot& claim_slot();
+
+    /**
+     * @brief Applies pending operations until a pass makes no progress.
+     * Must be called with combinerMtx held.
+     */
+    void combine();
+
+    /**
+     * @brief Applies the operation of one pending slot if possible.
+     * @return true if the operation completed.
+     */
+    bool apply(Slot& slot);
+
+    /**
+     * @brief Stores the outcome of an operation and wakes its thread if it
+     * sleeps.
+     */
+    void complete(Slot& slot, ChannelStatus status);
+
+    detail::RingBuffer<T, 0> ring;
+    std::unique_ptr<Slot[]> slots;
+    // One past the highest slot ever claimed; the combiner scans up to it
+    std::atomic<size_t> slotsInUse{0};
+    std::mutex combinerMtx;
+    std::atomic<bool> closed{false};
+};
+
+#include "combining_channel.cc"
+
+#endif  // COMBINING_CHANNEL_H
@@ -0,0 +1,169 @@
+#include "combining_channel.h"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+void test_basic_operations() {
+    log("Testing combining channel basic operations");
+    CombiningChannel<std::string> ch(2);
+    assert(ch.capacity() == 2 && ch.is_empty());
+    ch.send("a");
+    std::string b = "b";
+    ch.send(std::move(b));
+    assert(ch.size() == 2);
+    assert(!ch.try_send("c"));
+    assert(ch.try_send_status("c") == ChannelStatus::full);
+    assert(*ch.receive() == "a");
+    assert(*ch.try_receive() == "b");
+    assert(!ch.try_receive());
+
+    // A blocked receiver is woken by a send
+    std::thread receiver([&ch] { assert(*ch.receive() == "late"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ch.send("late");
+    receiver.join();
+
+    // Closing fails blocked senders and lets receivers drain
+    ch.send("x");
+    ch.send("y");
+    ChannelStatus status = ChannelStatus::ok;
+    std::thread sender([&ch, &status] { status = ch.send_status("z"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ch.close();
+    sender.join();
+    assert(status == ChannelStatus::closed);
+    assert(*ch.receive() == "x" && *ch.receive() == "y");
+    assert(!ch.receive());
+    bool threw = false;
+    try {
+        ch.send("after close");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    bool invalid = false;
+    try {
+        CombiningChannel<int> empty(0);
+    } catch (const std::invalid_argument&) {
+        invalid = true;
+    }
+    assert(invalid);
+    log("Basic operations test completed");
+}
+
+void test_many_threads() {
+    log("Testing combining channel with many threads");
+    constexpr int kProducers = 32;
+    constexpr int kConsumers = 32;
+    constexpr int kPerProducer = 2000;
+    CombiningChannel<int> ch(64);
+    std::vector<std::thread> threads;
+    std::vector<long long> sums(kConsumers, 0);
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&ch, &sum = sums[c]] {
+            while (auto value = ch.receive()) {
+                sum += *value;
+            }
+        });
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&ch, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                ch.send(p * kPerProducer + i);
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    ch.close();
+    for (auto& t : threads) {
+        t.join();
+    }
+    long long total = 0;
+    for (long long sum : sums) {
+        total += sum;
+    }
+    long long n = static_cast<long long>(kProducers) * kPerProducer;
+    assert(total == n * (n - 1) / 2 && "Lost or duplicated values");
+    log("Many threads test completed");
+}
+
+void test_per_sender_order() {
+    log("Testing per-sender order");
+    constexpr int kProducers = 8;
+    constexpr int kPerProducer = 5000;
+    CombiningChannel<int> ch(16);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&ch, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                ch.send(p * kPerProducer + i);
+            }
+        });
+    }
+    std::vector<int> last(kProducers, -1);
+    for (int i = 0; i < kProducers * kPerProducer; ++i) {
+        int value = *ch.receive();
+        int p = value / kPerProducer;
+        assert(value > last[p] && "Values of a sender out of order");
+        last[p] = value;
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    log("Per-sender order test completed");
+}
+
+struct Fragile {
+    Fragile() = default;
+    Fragile(const Fragile& other) : fail(other.fail) {
+        if (fail) {
+            throw std::logic_error("copy failed");
+        }
+    }
+    Fragile& operator=(const Fragile&) = default;
+    Fragile(Fragile&&) noexcept = default;
+    bool fail = false;
+};
+
+void test_exception_in_combiner() {
+    log("Testing exceptions thrown while combining");
+    CombiningChannel<Fragile> ch(4);
+    Fragile bad;
+    bad.fail = true;
+    bool threw = false;
+    try {
+        ch.send(bad);  // Copied by whichever thread combines
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw && ch.is_empty());
+    ch.send(Fragile());
+    assert(ch.receive());
+    log("Exception test completed");
+}
+
+int main() {
+    log("Starting combining channel tests");
+
+    test_basic_operations();
+    test_many_threads();
+    test_per_sender_order();
+    test_exception_in_combiner();
+
+    log("All tests completed successfully");
+    return 0;
+}
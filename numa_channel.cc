@@ -0,0 +1,128 @@
+#include "numa_channel.h"
+
+#include <algorithm>
+
+template <typename T>
+NumaChannel<T>::NumaChannel(size_t shard_capacity,
+                            const std::vector<int>& nodes) {
+    if (shard_capacity == 0 || nodes.empty()) {
+        throw std::invalid_argument(
+            "A NumaChannel needs nodes and a shard capacity greater than 0");
+    }
+    int highest = *std::max_element(nodes.begin(), nodes.end());
+    shard_of_node.assign(static_cast<size_t>(std::max(highest, 0)) + 1, 0);
+    shards.reserve(nodes.size());
+    for (size_t i = nodes.size(); i-- > 0;) {
+        if (nodes[i] >= 0) {
+            shard_of_node[nodes[i]] = i;  // The first listing of a node wins
+        }
+    }
+    for (int node : nodes) {
+        shards.push_back(std::make_unique<Shard>(
+            shard_capacity, StorageOptions::on_node(node)));
+    }
+}
+
+template <typename T>
+size_t NumaChannel<T>::local_shard() const {
+    size_t node = static_cast<size_t>(detail::current_numa_node());
+    return node < shard_of_node.size() ? shard_of_node[node] : 0;
+}
+
+template <typename T>
+void NumaChannel<T>::send(const T& value) {
+    size_t local = local_shard();
+    const size_t n = shards.size();
+    bool sent = false;
+    for (size_t i = 0; i < n && !sent; ++i) {
+        sent = shards[(local + i) % n]->try_send(value);
+    }
+    if (!sent) {
+        // Wait for room close to home
+        shards[local]->send(value);
+    }
+    wake_receiver();
+}
+
+template <typename T>
+bool NumaChannel<T>::try_send(const T& value) {
+    size_t local = local_shard();
+    const size_t n = shards.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (shards[(local + i) % n]->try_send(value)) {
+            wake_receiver();
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+std::optional<T> NumaChannel<T>::receive() {
+    size_t local = local_shard();
+    while (true) {
+        if (auto value = try_receive_from(local)) {
+            return value;
+        }
+        std::unique_lock<std::mutex> lock(mtx);
+        // Announce ourselves before the last check, pairing with the fence
+        // in wake_receiver(), so a value sent meanwhile is either seen here
+        // or the sender notifies us
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        cv_recv.wait(lock, [this] { return any_ready() || closed; });
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        if (closed && !any_ready()) {
+            return std::nullopt;
+        }
+    }
+}
+
+template <typename T>
+std::optional<T> NumaChannel<T>::try_receive() {
+    return try_receive_from(local_shard());
+}
+
+template <typename T>
+void NumaChannel<T>::close() {
+    std::unique_lock<std::mutex> lock(mtx);
+    closed = true;
+    for (auto& shard : shards) {
+        shard->close();
+    }
+    cv_recv.notify_all();
+}
+
+template <typename T>
+size_t NumaChannel<T>::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->size();
+    }
+    return total;
+}
+
+template <typename T>
+std::optional<T> NumaChannel<T>::try_receive_from(size_t first) {
+    const size_t n = shards.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (auto value = shards[(first + i) % n]->try_receive()) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename T>
+bool NumaChannel<T>::any_ready() const {
+    return std::any_of(shards.begin(), shards.end(),
+                       [](const auto& shard) { return !shard->is_empty(); });
+}
+
+template <typename T>
+void NumaChannel<T>::wake_receiver() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) > 0) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_recv.notify_one();
+    }
+}
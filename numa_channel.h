@@ -0,0 +1,164 @@
+#ifndef NUMA_CHANNEL_H
+#define NUMA_CHANNEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "channel.h"
+
+/**
+ * @brief A multi-producer, multi-consumer channel sharded by NUMA node.
+ *
+ * Every node gets its own bounded ring, with its slots bound to that node.
+ * A sender pushes to the shard of the node it runs on and a receiver pops
+ * from its own node's shard first, so as long as both sides have work on the
+ * same node, values never cross the interconnect. A sender spills to another
+ * shard only when its own is full, and a receiver takes from other shards
+ * only when its own is empty.
+ *
+ * Values from one sender arrive in order as long as the sender stays on one
+ * node and does not spill; there is no order across shards.
+ *
+ * @tparam T The type of the values.
+ */
+template <typename T>
+class NumaChannel {
+   public:
+    using Shard = Channel<T, ChannelPolicy<channel_policy::multi,
+                                           channel_policy::multi,
+                                           channel_policy::bounded_ring>>;
+
+    /**
+     * @brief Constructs a NumaChannel object with one shard per node the
+     * process may allocate from.
+     * @param shard_capacity The capacity of each shard. Must be greater than
+     * 0.
+     * @throws std::invalid_argument if shard_capacity is 0.
+     *
+     * Use Case: Pass work between thread pools spread over several sockets
+     * while keeping most transfers on one socket.
+     * Example: NumaChannel<Task> ch(1024);
+     */
+    explicit NumaChannel(size_t shard_capacity)
+        : NumaChannel(shard_capacity, detail::numa_nodes()) {}
+
+    /**
+     * @brief Constructs a NumaChannel object with one shard per listed node.
+     * @param shard_capacity The capacity of each shard. Must be greater than
+     * 0.
+     * @param nodes The nodes to create shards on. Threads on a node that is
+     * not listed use the first shard.
+     * @throws std::invalid_argument if shard_capacity is 0 or nodes is empty.
+     */
+    NumaChannel(size_t shard_capacity, const std::vector<int>& nodes);
+
+    // Disable copying and moving
+    NumaChannel(const NumaChannel&) = delete;
+    NumaChannel& operator=(const NumaChannel&) = delete;
+    NumaChannel(NumaChannel&&) = delete;
+    NumaChannel& operator=(NumaChannel&&) = delete;
+
+    // Destructor
+    ~NumaChannel() { close(); }
+
+    /**
+     * @brief Sends a value to the shard of the caller's node, or to another
+     * shard if that one is full. Blocks on the caller's shard if all shards
+     * are full.
+     * @param value The value to send.
+     * @throws std::runtime_error if the channel is closed.
+     *
+     * Example: ch.send(task);
+     */
+    void send(const T& value);
+
+    /**
+     * @brief Attempts to send a value without blocking.
+     * @param value The value to send.
+     * @return true if the value was sent, false if every shard is full or the
+     * channel is closed.
+     */
+    bool try_send(const T& value);
+
+    /**
+     * @brief Receives a value, preferring the shard of the caller's node.
+     * Blocks until a value is available.
+     * @return The received value, or std::nullopt once the channel is closed
+     * and every shard is empty.
+     *
+     * Example: while (auto task = ch.receive()) { run(*task); }
+     */
+    std::optional<T> receive();
+
+    /**
+     * @brief Attempts to receive a value without blocking.
+     * @return The received value, or std::nullopt if every shard is empty.
+     */
+    std::optional<T> try_receive();
+
+    /**
+     * @brief Closes every shard and wakes all waiting receivers.
+     */
+    void close();
+
+    /**
+     * @brief Checks if the channel is closed.
+     */
+    bool is_closed() const {
+        std::unique_lock<std::mutex> lock(mtx);
+        return closed;
+    }
+
+    /**
+     * @brief Returns the number of values in all shards.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns the number of shards.
+     */
+    size_t shard_count() const { return shards.size(); }
+
+    /**
+     * @brief Returns the shard used by the calling thread.
+     */
+    size_t local_shard() const;
+
+    /**
+     * @brief Returns the number of values in a shard.
+     */
+    size_t shard_size(size_t shard) const { return shards.at(shard)->size(); }
+
+   private:
+    /**
+     * @brief Takes a value from the shards, starting at first.
+     */
+    std::optional<T> try_receive_from(size_t first);
+
+    /**
+     * @brief Checks if any shard holds a value.
+     */
+    bool any_ready() const;
+
+    /**
+     * @brief Wakes a receiver sleeping on the channel, if there is one.
+     */
+    void wake_receiver();
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<size_t> shard_of_node;  // Indexed by node; 0 if unlisted
+
+    mutable std::mutex mtx;
+    std::condition_variable cv_recv;
+    std::atomic<size_t> sleepers{0};  // Receivers waiting on cv_recv
+    bool closed = false;
+};
+
+#include "numa_channel.cc"
+
+#endif  // NUMA_CHANNEL_H
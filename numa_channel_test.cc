@@ -0,0 +1,175 @@
+#include "numa_channel.h"
+
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+void test_storage_placement() {
+    log("Testing ring storage placement options");
+    const auto& nodes = detail::numa_nodes();
+    assert(!nodes.empty());
+    log("NUMA nodes available: " + std::to_string(nodes.size()));
+
+    StorageOptions interleaved;
+    interleaved.placement = NumaPlacement::interleaved;
+    StorageOptions consumer_local;
+    consumer_local.placement = NumaPlacement::consumer_local;
+    std::vector<StorageOptions> all = {StorageOptions(),
+                                       StorageOptions::on_node(nodes.back()),
+                                       interleaved, consumer_local};
+    for (const auto& options : all) {
+        SpscChannel<int> ch(100, options);
+        std::thread producer([&ch] {
+            for (int i = 0; i < 10000; ++i) {
+                ch.send(i);
+            }
+            ch.close();
+        });
+        int expected = 0;
+        while (auto value = ch.receive()) {
+            assert(*value == expected);
+            expected++;
+        }
+        producer.join();
+        assert(expected == 10000);
+    }
+
+    // The mapping itself: page-rounded, zeroed and writable. Placement may
+    // be refused where the kernel has no NUMA support, which is not an error.
+    detail::MappedMemory memory(100, StorageOptions::on_node(nodes.front()));
+    assert(memory.size() >= 100 && memory.size() % 4096 == 0);
+    auto* bytes = static_cast<unsigned char*>(memory.data());
+    assert(bytes[0] == 0 && bytes[99] == 0);
+    bytes[99] = 1;
+    log(std::string("Placement on node ") + std::to_string(nodes.front()) +
+        (memory.is_placed() ? " applied" : " not supported"));
+
+    // Lengths whose page rounding would wrap around are refused, both for
+    // the mapping itself and for a placed ring
+    StorageOptions huge;
+    huge.huge_pages = true;
+    for (const auto& options : {StorageOptions::on_node(0), huge}) {
+        try {
+            detail::MappedMemory wrapped(
+                std::numeric_limits<size_t>::max() - 100, options);
+            assert(false && "Expected exception was not thrown");
+        } catch (const std::length_error& e) {
+            log("Caught expected exception: " + std::string(e.what()));
+        }
+    }
+    try {
+        SpscChannel<int> oversized(std::numeric_limits<size_t>::max() / 4 + 3,
+                                   StorageOptions::on_node(0));
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::length_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    log("Storage placement test completed");
+}
+
+void test_local_transfer() {
+    log("Testing transfers through the local shard");
+    NumaChannel<int> ch(16);
+    assert(ch.shard_count() == detail::numa_nodes().size());
+    assert(ch.local_shard() < ch.shard_count());
+
+    constexpr int kPerProducer = 20000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < 3; ++p) {
+        producers.emplace_back([&ch, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                ch.send(p * kPerProducer + i);
+            }
+        });
+    }
+    std::vector<long long> sums(2, 0);
+    std::vector<int> counts(2, 0);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < 2; ++c) {
+        consumers.emplace_back([&ch, &sums, &counts, c] {
+            while (auto value = ch.receive()) {
+                sums[c] += *value;
+                counts[c]++;
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    ch.close();
+    for (auto& t : consumers) {
+        t.join();
+    }
+
+    long long total = 3LL * kPerProducer;
+    assert(counts[0] + counts[1] == total && "Lost values");
+    assert(sums[0] + sums[1] == total * (total - 1) / 2 &&
+           "Corrupted values");
+    log("Local transfer test completed");
+}
+
+void test_spill_and_steal() {
+    log("Testing spilling to and stealing from remote shards");
+    // Two shards on the same node: this thread's shard is the first one, so
+    // the second one only sees spilled values
+    int node = detail::numa_nodes().front();
+    NumaChannel<int> ch(2, {node, node});
+    assert(ch.shard_count() == 2);
+    size_t local = ch.local_shard();
+
+    for (int i = 0; i < 4; ++i) {
+        assert(ch.try_send(i));
+    }
+    assert(!ch.try_send(4));  // Both shards full
+    assert(ch.shard_size(local) == 2 && ch.shard_size(1 - local) == 2);
+    assert(ch.size() == 4);
+
+    // Own shard first, in order, then the other shard
+    assert(*ch.try_receive() == 0 && *ch.try_receive() == 1);
+    assert(*ch.try_receive() == 2 && *ch.try_receive() == 3);
+    assert(!ch.try_receive());
+
+    // A blocked receiver is woken by a send to any shard
+    std::thread consumer([&ch] { assert(*ch.receive() == 42); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ch.send(42);
+    consumer.join();
+
+    ch.close();
+    assert(ch.is_closed() && !ch.receive() && !ch.try_send(1));
+    try {
+        ch.send(1);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::runtime_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    try {
+        NumaChannel<int> invalid(0);
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::invalid_argument& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    log("Spill and steal test completed");
+}
+
+int main() {
+    log("Starting NUMA channel tests");
+
+    test_storage_placement();
+    test_local_transfer();
+    test_spill_and_steal();
+
+    log("All tests completed successfully");
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include "partitioned_channel.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+template <typename T, typename Key, typename Hash>
+PartitionedChannel<T, Key, Hash>::PartitionedChannel(size_t partitions_count,
+                                                     size_t workers_count,
+                                                     KeyExtractor key_of,
+                                                     size_t partition_capacity)
+    : key_of(std::move(key_of)) {
+    if (partitions_count == 0 || workers_count == 0 ||
+        partition_capacity == 0) {
+        throw std::invalid_argument(
+            "Partitions, workers and partition capacity must be non-zero");
+    }
+    workers.reserve(workers_count);
+    for (size_t i = 0; i < workers_count; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    partitions.reserve(partitions_count);
+    for (size_t i = 0; i < partitions_count; ++i) {
+        partitions.push_back(std::make_unique<Partition>(partition_capacity));
+        // Initial round-robin assignment
+        partitions.back()->owner = i % workers_count;
+    }
+}
+
+template <typename T, typename Key, typename Hash>
+void PartitionedChannel<T, Key, Hash>::send(const T& value) {
+    size_t p = partition_of(key_of(value));
+    Partition& partition = *partitions[p];
+    // Blocking happens on the partition itself; only its owner is woken
+    partition.channel.send(value);
+    partition.sent.fetch_add(1, std::memory_order_relaxed);
+    notify_owner(p);
+}
+
+template <typename T, typename Key, typename Hash>
+bool PartitionedChannel<T, Key, Hash>::try_send(const T& value) {
+    size_t p = partition_of(key_of(value));
+    Partition& partition = *partitions[p];
+    if (!partition.channel.try_send(value)) {
+        return false;
+    }
+    partition.sent.fetch_add(1, std::memory_order_relaxed);
+    notify_owner(p);
+    return true;
+}
+
+template <typename T, typename Key, typename Hash>
+std::optional<T> PartitionedChannel<T, Key, Hash>::receive(size_t worker) {
+    check_worker(worker);
+    Worker& self = *workers[worker];
+    release_held(worker);
+    while (true) {
+        {
+            // Wakeups from here on trigger another pass
+            std::unique_lock<std::mutex> lock(self.mtx);
+            self.signalled = false;
+        }
+        if (auto value = try_take(worker)) {
+            return value;
+        }
+        if (closed) {
+            // Keep waiting while an owned partition still has values that are
+            // blocked behind the previous owner.
+            bool pending = std::any_of(
+                partitions.begin(), partitions.end(), [worker](const auto& p) {
+                    return p->owner == worker && !p->channel.is_empty();
+                });
+            if (!pending) {
+                return std::nullopt;
+            }
+        }
+        std::unique_lock<std::mutex> lock(self.mtx);
+        self.cv.wait(lock, [&self] { return self.signalled; });
+    }
+}
+
+template <typename T, typename Key, typename Hash>
+std::optional<T> PartitionedChannel<T, Key, Hash>::try_receive(size_t worker) {
+    check_worker(worker);
+    release_held(worker);
+    return try_take(worker);
+}
+
+template <typename T, typename Key, typename Hash>
+void PartitionedChannel<T, Key, Hash>::release(size_t worker) {
+    check_worker(worker);
+    release_held(worker);
+}
+
+template <typename T, typename Key, typename Hash>
+void PartitionedChannel<T, Key, Hash>::close() {
+    std::unique_lock<std::mutex> lock(mtx);
+    closed = true;
+    for (auto& partition : partitions) {
+        partition->channel.close();
+    }
+    for (size_t w = 0; w < workers.size(); ++w) {
+        notify_worker(w);
+    }
+}
+
+template <typename T, typename Key, typename Hash>
+size_t PartitionedChannel<T, Key, Hash>::owner(size_t partition) const {
+    return partitions.at(partition)->owner;
+}
+
+template <typename T, typename Key, typename Hash>
+void PartitionedChannel<T, Key, Hash>::assign(size_t partition, size_t worker) {
+    check_worker(worker);
+    std::unique_lock<std::mutex> lock(mtx);
+    partitions.at(partition)->owner = worker;
+    notify_worker(worker);
+}
+
+template <typename T, typename Key, typename Hash>
+void PartitionedChannel<T, Key, Hash>::rebalance() {
+    std::unique_lock<std::mutex> lock(mtx);
+
+    // Traffic of each partition since the previous rebalance
+    std::vector<std::pair<uint64_t, size_t>> loads;
+    loads.reserve(partitions.size());
+    for (size_t p = 0; p < partitions.size(); ++p) {
+        uint64_t sent = partitions[p]->sent.load(std::memory_order_relaxed);
+        loads.emplace_back(sent - partitions[p]->sent_at_rebalance, p);
+        partitions[p]->sent_at_rebalance = sent;
+    }
+    std::sort(loads.begin(), loads.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    // Heaviest partition first onto the least loaded worker; ties are broken
+    // by the number of partitions so idle partitions still spread out.
+    std::vector<std::pair<uint64_t, size_t>> worker_loads(workers.size(),
+                                                          {0, 0});
+    for (const auto& [load, p] : loads) {
+        auto it = std::min_element(worker_loads.begin(), worker_loads.end());
+        size_t worker = static_cast<size_t>(it - worker_loads.begin());
+        it->first += load;
+        ++it->second;
+        partitions[p]->owner = worker;
+    }
+
+    for (size_t w = 0; w < workers.size(); ++w) {
+        notify_worker(w);
+    }
+}
+
+template <typename T, typename Key, typename Hash>
+std::vector<PartitionStats> PartitionedChannel<T, Key, Hash>::stats() const {
+    std::unique_lock<std::mutex> lock(mtx);
+    std::vector<PartitionStats> result;
+    result.reserve(partitions.size());
+    uint64_t total = 0;
+    for (size_t p = 0; p < partitions.size(); ++p) {
+        const Partition& partition = *partitions[p];
+        uint64_t sent = partition.sent.load(std::memory_order_relaxed);
+        total += sent;
+        result.push_back({p, partition.owner, sent,
+                          partition.received.load(std::memory_order_relaxed),
+                          partition.channel.size(), 0.0});
+    }
+    if (total > 0) {
+        double mean = static_cast<double>(total) / partitions.size();
+        for (auto& s : result) {
+            s.skew = s.sent / mean;
+        }
+    }
+    return result;
+}
+
+template <typename T, typename Key, typename Hash>
+double PartitionedChannel<T, Key, Hash>::skew() const {
+    auto all = stats();
+    double max_skew = 0.0;
+    for (const auto& s : all) {
+        max_skew = std::max(max_skew, s.skew);
+    }
+    return max_skew;
+}
+
+template <typename T, typename Key, typename Hash>
+void PartitionedChannel<T, Key, Hash>::unclaim(size_t partition,
+                                               size_t worker) {
+    Partition& p = *partitions[partition];
+    p.holder.store(npos);
+    // Pairs with the claim in try_take(): either the new owner sees the
+    // partition free, or we see it was moved and wake the new owner.
+    size_t owner = p.owner.load();
+    if (owner != worker) {
+        notify_worker(owner);
+    }
+}
+
+template <typename T, typename Key, typename Hash>
+void PartitionedChannel<T, Key, Hash>::release_held(size_t worker) {
+    Worker& self = *workers[worker];
+    if (self.held != npos) {
+        unclaim(std::exchange(self.held, npos), worker);
+    }
+}
+
+template <typename T, typename Key, typename Hash>
+std::optional<T> PartitionedChannel<T, Key, Hash>::try_take(size_t worker) {
+    Worker& self = *workers[worker];
+    const size_t n = partitions.size();
+    for (size_t i = 0; i < n; ++i) {
+        size_t p = (self.cursor + i) % n;
+        Partition& partition = *partitions[p];
+        if (partition.owner.load() != worker ||
+            partition.channel.is_empty()) {
+            continue;
+        }
+        size_t free = npos;
+        if (!partition.holder.compare_exchange_strong(free, worker)) {
+            continue;  // The previous owner is still processing a value
+        }
+        // Ownership may have moved between the check and the claim
+        if (partition.owner.load() == worker) {
+            if (auto value = partition.channel.try_receive()) {
+                partition.received.fetch_add(1, std::memory_order_relaxed);
+                self.held = p;
+                self.cursor = (p + 1) % n;
+                return value;
+            }
+        }
+        unclaim(p, worker);
+    }
+    return std::nullopt;
+}
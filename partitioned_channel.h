@@ -0,0 +1,276 @@
+#ifndef PARTITIONED_CHANNEL_H
+#define PARTITIONED_CHANNEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "channel.h"
+
+/**
+ * @brief Per-partition statistics reported by PartitionedChannel::stats().
+ */
+struct PartitionStats {
+    size_t partition;    // Index of the partition
+    size_t owner;        // Worker currently assigned to the partition
+    uint64_t sent;       // Values routed to the partition so far
+    uint64_t received;   // Values handed to workers so far
+    size_t pending;      // Values currently buffered in the partition
+    double skew;         // Share of traffic relative to the mean (1.0 = even)
+};
+
+/**
+ * @brief A keyed channel split into N partitions consumed by parallel workers.
+ *
+ * Every value is routed to a partition by hashing the key returned by the key
+ * extractor, so all values with the same key travel through the same
+ * partition. Each partition is owned by exactly one worker at a time and a
+ * partition is never handed to a second worker while the first is still
+ * processing a value from it, which preserves per-key ordering while letting
+ * throughput scale with the number of partitions.
+ *
+ * A worker's previous value counts as processed once it calls receive() again
+ * (or release()). Ownership can be changed at runtime with assign() or
+ * rebalance(); the change takes effect as soon as the old owner has finished
+ * the value it is holding.
+ *
+ * Sends and receives never take a lock shared by all partitions: a worker is
+ * woken through its own mutex and condition variable, and claims a partition
+ * with one CAS. The channel-wide lock is only taken by close() and by the
+ * calls that move or inspect ownership.
+ *
+ * @tparam T The type of the values.
+ * @tparam Key The type returned by the key extractor.
+ * @tparam Hash The hash function used to map keys onto partitions.
+ */
+template <typename T, typename Key, typename Hash = std::hash<Key>>
+class PartitionedChannel {
+   public:
+    using KeyExtractor = std::function<Key(const T&)>;
+
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    /**
+     * @brief Constructs a PartitionedChannel object.
+     * @param partitions The number of partitions. Must be at least 1.
+     * @param workers The number of workers consuming the partitions. Must be
+     * at least 1. Partitions are initially assigned round-robin.
+     * @param key_of Extracts the routing key from a value.
+     * @param partition_capacity The buffer size of each partition. Must be
+     * greater than 0.
+     * @throws std::invalid_argument if any of the sizes is 0.
+     *
+     * Use Case: Preserve per-key ordering (e.g. per-account events) while
+     * consuming in parallel.
+     * Example: PartitionedChannel<Event, AccountId> ch(
+     *              16, 4, [](const Event& e) { return e.account; });
+     */
+    PartitionedChannel(size_t partitions, size_t workers, KeyExtractor key_of,
+                       size_t partition_capacity = 64);
+
+    // Disable copying and moving
+    PartitionedChannel(const PartitionedChannel&) = delete;
+    PartitionedChannel& operator=(const PartitionedChannel&) = delete;
+    PartitionedChannel(PartitionedChannel&&) = delete;
+    PartitionedChannel& operator=(PartitionedChannel&&) = delete;
+
+    // Destructor
+    ~PartitionedChannel() { close(); }
+
+    /**
+     * @brief Sends a value to the partition selected by its key. Blocks if
+     * that partition is full.
+     * @param value The value to send.
+     * @throws std::runtime_error if the channel is closed.
+     *
+     * Example: ch.send(event);
+     */
+    void send(const T& value);
+
+    /**
+     * @brief Attempts to send a value without blocking.
+     * @param value The value to send.
+     * @return true if the value was sent, false if the partition is full or
+     * the channel is closed.
+     */
+    bool try_send(const T& value);
+
+    /**
+     * @brief Receives the next value from one of the partitions owned by a
+     * worker. Blocks until a value is available.
+     *
+     * Calling receive() marks the value previously returned to this worker as
+     * processed, allowing its partition to move to another worker.
+     *
+     * @param worker The index of the calling worker.
+     * @return The received value, or std::nullopt once the channel is closed
+     * and all partitions owned by the worker are empty.
+     *
+     * Example: while (auto event = ch.receive(worker_id)) { handle(*event); }
+     */
+    std::optional<T> receive(size_t worker);
+
+    /**
+     * @brief Attempts to receive a value for a worker without blocking.
+     * @param worker The index of the calling worker.
+     * @return The received value, or std::nullopt if none is available.
+     */
+    std::optional<T> try_receive(size_t worker);
+
+    /**
+     * @brief Marks the value last returned to a worker as processed without
+     * receiving another one. Call this before a worker stops.
+     * @param worker The index of the worker.
+     */
+    void release(size_t worker);
+
+    /**
+     * @brief Closes every partition and wakes all waiting workers.
+     */
+    void close();
+
+    /**
+     * @brief Checks if the channel is closed.
+     */
+    bool is_closed() const { return closed.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Returns the partition a key is routed to.
+     */
+    size_t partition_of(const Key& key) const {
+        return hash(key) % partitions.size();
+    }
+
+    /**
+     * @brief Returns the number of partitions.
+     */
+    size_t partition_count() const { return partitions.size(); }
+
+    /**
+     * @brief Returns the number of workers.
+     */
+    size_t worker_count() const { return workers.size(); }
+
+    /**
+     * @brief Returns the worker currently assigned to a partition.
+     */
+    size_t owner(size_t partition) const;
+
+    /**
+     * @brief Assigns a partition to a worker.
+     * @param partition The index of the partition.
+     * @param worker The index of the new owner.
+     *
+     * Use Case: Move a hot partition to an idle worker.
+     */
+    void assign(size_t partition, size_t worker);
+
+    /**
+     * @brief Redistributes partitions across workers based on the traffic
+     * each partition received since the previous rebalance.
+     *
+     * Partitions are placed heaviest first on the least loaded worker, which
+     * keeps the busiest worker within one partition of the optimum.
+     *
+     * Use Case: Periodically even out load when some keys are much hotter
+     * than others.
+     */
+    void rebalance();
+
+    /**
+     * @brief Returns statistics for every partition.
+     */
+    std::vector<PartitionStats> stats() const;
+
+    /**
+     * @brief Returns the traffic of the busiest partition relative to the
+     * mean (1.0 means perfectly even, 0 if nothing was sent yet).
+     */
+    double skew() const;
+
+   private:
+    struct Partition {
+        explicit Partition(size_t cap) : channel(cap) {}
+
+        Channel<T> channel;
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> received{0};
+        uint64_t sent_at_rebalance = 0;  // Guarded by mtx
+        std::atomic<size_t> owner{0};
+        // Worker looking into or processing a value from the partition;
+        // claimed with a CAS so the partition has one reader at a time
+        std::atomic<size_t> holder{npos};
+    };
+
+    /**
+     * @brief The state of one worker. Only the worker itself touches cursor
+     * and held; the others wake it through mtx and cv.
+     */
+    struct Worker {
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool signalled = false;  // Set when the worker should look again
+        size_t cursor = 0;       // Round-robin position
+        size_t held = npos;      // Partition held by the worker, or npos
+    };
+
+    /**
+     * @brief Wakes the owner of a partition.
+     */
+    void notify_owner(size_t partition) {
+        notify_worker(partitions[partition]->owner.load());
+    }
+
+    void notify_worker(size_t worker) {
+        Worker& w = *workers[worker];
+        {
+            std::unique_lock<std::mutex> lock(w.mtx);
+            w.signalled = true;
+        }
+        w.cv.notify_one();
+    }
+
+    /**
+     * @brief Gives up a worker's claim on a partition, handing the partition
+     * to its owner if it was moved meanwhile.
+     */
+    void unclaim(size_t partition, size_t worker);
+
+    /**
+     * @brief Releases the partition held by a worker. Must be called by the
+     * worker itself.
+     */
+    void release_held(size_t worker);
+
+    /**
+     * @brief Takes a value from one of the worker's partitions. Must be
+     * called by the worker itself.
+     */
+    std::optional<T> try_take(size_t worker);
+
+    void check_worker(size_t worker) const {
+        if (worker >= workers.size()) {
+            throw std::out_of_range("Invalid worker index");
+        }
+    }
+
+    std::vector<std::unique_ptr<Partition>> partitions;
+    std::vector<std::unique_ptr<Worker>> workers;
+    KeyExtractor key_of;
+    Hash hash;
+
+    // Serializes close() and changes of ownership
+    mutable std::mutex mtx;
+    std::atomic<bool> closed{false};
+};
+
+#include "partitioned_channel.cc"
+
+#endif  // PARTITIONED_CHANNEL_H
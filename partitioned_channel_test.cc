@@ -0,0 +1,147 @@
+#include "partitioned_channel.h"
+
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+struct Event {
+    int account;
+    int sequence;
+};
+
+void test_per_key_ordering() {
+    log("Testing per-key ordering with parallel workers");
+    const int num_workers = 4;
+    const int num_accounts = 32;
+    const int events_per_account = 200;
+    PartitionedChannel<Event, int> ch(
+        8, num_workers, [](const Event& e) { return e.account; }, 16);
+
+    std::vector<std::map<int, int>> last_seen(num_workers);
+    std::vector<int> counts(num_workers, 0);
+    std::vector<std::thread> workers;
+    for (int w = 0; w < num_workers; ++w) {
+        workers.emplace_back([&, w] {
+            while (auto e = ch.receive(w)) {
+                auto it = last_seen[w].find(e->account);
+                // Each account lives on one partition owned by one worker
+                if (it != last_seen[w].end()) {
+                    assert(e->sequence == it->second + 1 &&
+                           "Out of order event for account");
+                }
+                last_seen[w][e->account] = e->sequence;
+                counts[w]++;
+            }
+        });
+    }
+
+    for (int seq = 0; seq < events_per_account; ++seq) {
+        for (int account = 0; account < num_accounts; ++account) {
+            ch.send({account, seq});
+        }
+    }
+    ch.close();
+    for (auto& t : workers) t.join();
+
+    int total = 0;
+    for (int c : counts) total += c;
+    assert(total == num_accounts * events_per_account &&
+           "Incorrect number of events received");
+    log("Per-key ordering test completed");
+}
+
+void test_rebalance_preserves_order() {
+    log("Testing ordering across rebalances");
+    const int num_workers = 2;
+    const int events = 2000;
+    PartitionedChannel<Event, int> ch(
+        4, num_workers, [](const Event& e) { return e.account; }, 8);
+
+    std::mutex seen_mtx;
+    std::map<int, int> last_seen;
+    int received = 0;
+    std::vector<std::thread> workers;
+    for (int w = 0; w < num_workers; ++w) {
+        workers.emplace_back([&, w] {
+            while (auto e = ch.receive(w)) {
+                std::unique_lock<std::mutex> lock(seen_mtx);
+                auto it = last_seen.find(e->account);
+                if (it != last_seen.end()) {
+                    assert(e->sequence == it->second + 1 &&
+                           "Out of order event after rebalance");
+                }
+                last_seen[e->account] = e->sequence;
+                received++;
+            }
+        });
+    }
+
+    for (int seq = 0; seq < events; ++seq) {
+        ch.send({seq % 3, seq / 3});
+        if (seq % 100 == 0) {
+            // Move partitions around while values are in flight
+            ch.assign(ch.partition_of(seq % 3), (seq / 100) % num_workers);
+            ch.rebalance();
+        }
+    }
+    ch.close();
+    for (auto& t : workers) t.join();
+
+    assert(received == events && "Incorrect number of events received");
+    log("Rebalance ordering test completed");
+}
+
+void test_skew_and_rebalance() {
+    log("Testing skew reporting and rebalance");
+    PartitionedChannel<int, int> ch(
+        4, 2, [](const int& v) { return v; }, 1024);
+
+    // All traffic on two keys that land on different partitions
+    int hot_a = 0;
+    int hot_b = 1;
+    assert(ch.partition_of(hot_a) != ch.partition_of(hot_b));
+    for (int i = 0; i < 300; ++i) ch.send(hot_a);
+    for (int i = 0; i < 100; ++i) ch.send(hot_b);
+
+    auto stats = ch.stats();
+    assert(stats.size() == 4 && "Expected one entry per partition");
+    assert(stats[ch.partition_of(hot_a)].sent == 300);
+    assert(stats[ch.partition_of(hot_a)].pending == 300);
+    assert(stats[ch.partition_of(hot_a)].skew == 3.0 &&
+           "Hot partition should carry three times the mean");
+    assert(ch.skew() == 3.0 && "Unexpected overall skew");
+    log("Reported skew: " + std::to_string(ch.skew()));
+
+    ch.rebalance();
+    assert(ch.owner(ch.partition_of(hot_a)) !=
+               ch.owner(ch.partition_of(hot_b)) &&
+           "Hot partitions should be spread across workers");
+
+    // Drain everything from both workers
+    int drained = 0;
+    for (size_t w = 0; w < ch.worker_count(); ++w) {
+        while (ch.try_receive(w)) drained++;
+    }
+    assert(drained == 400 && "Failed to drain all values");
+    log("Skew and rebalance test completed");
+}
+
+int main() {
+    log("Starting PartitionedChannel tests");
+
+    test_per_key_ordering();
+    test_rebalance_preserves_order();
+    test_skew_and_rebalance();
+
+    log("All tests completed successfully");
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include "request_channel.h"
+
+template <typename Req, typename Resp>
+RequestChannel<Req, Resp>::RequestChannel(size_t max_outstanding)
+    : slots(max_outstanding), ring(max_outstanding) {
+    if (max_outstanding == 0 || max_outstanding > UINT32_MAX) {
+        throw std::invalid_argument("Invalid number of reply slots");
+    }
+    free_slots.reserve(max_outstanding);
+    for (size_t i = max_outstanding; i > 0; --i) {
+        free_slots.push_back(static_cast<uint32_t>(i - 1));
+    }
+}
+
+template <typename Req, typename Resp>
+typename RequestChannel<Req, Resp>::Reply RequestChannel<Req, Resp>::call(
+    const Req& request) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (closed) {
+        throw std::runtime_error("Call on closed channel");
+    }
+    // Wait until a reply slot is free or the channel is closed
+    cv_slot.wait(lock, [this] { return !free_slots.empty() || closed; });
+    if (closed) {
+        throw std::runtime_error("Channel closed while waiting to call");
+    }
+    return enqueue_locked(request);
+}
+
+template <typename Req, typename Resp>
+std::optional<typename RequestChannel<Req, Resp>::Reply>
+RequestChannel<Req, Resp>::try_call(const Req& request) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (closed || free_slots.empty()) {
+        return std::nullopt;
+    }
+    return enqueue_locked(request);
+}
+
+template <typename Req, typename Resp>
+std::optional<typename RequestChannel<Req, Resp>::Request>
+RequestChannel<Req, Resp>::receive() {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv_recv.wait(lock, [this] { return ring_size > 0 || closed; });
+    if (closed) {
+        return std::nullopt;
+    }
+    uint32_t index = ring[ring_head];
+    ring_head = (ring_head + 1) % ring.size();
+    --ring_size;
+    Slot& slot = slots[index];
+    slot.state = SlotState::in_service;
+    Request request{make_id(index, slot.generation), std::move(*slot.request)};
+    slot.request.reset();
+    return request;
+}
+
+template <typename Req, typename Resp>
+bool RequestChannel<Req, Resp>::reply(CorrelationId id, const Resp& response) {
+    std::unique_lock<std::mutex> lock(mtx);
+    Slot* slot = find_locked(id);
+    if (closed || !slot || slot->state != SlotState::in_service) {
+        return false;  // Stale, cancelled or abandoned by close()
+    }
+    slot->response = response;
+    slot->state = SlotState::ready;
+    slot->cv.notify_one();  // Wake exactly the caller of this request
+    return true;
+}
+
+template <typename Req, typename Resp>
+void RequestChannel<Req, Resp>::close() {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (closed) {
+        return;
+    }
+    closed = true;
+    // Nobody will receive the queued requests anymore; their slots are freed
+    // when the owning Reply is consumed or destroyed.
+    ring_size = 0;
+    cv_recv.notify_all();  // Notify all waiting servers
+    cv_slot.notify_all();  // Notify all callers waiting for a slot
+    for (auto& slot : slots) {
+        slot.cv.notify_all();  // Notify all callers waiting for a reply
+    }
+}
+
+template <typename Req, typename Resp>
+typename RequestChannel<Req, Resp>::Slot* RequestChannel<Req, Resp>::find_locked(
+    CorrelationId id) {
+    uint32_t index = static_cast<uint32_t>(id & 0xffffffffu);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (index >= slots.size()) {
+        return nullptr;
+    }
+    Slot& slot = slots[index];
+    if (slot.generation != generation || slot.state == SlotState::free) {
+        return nullptr;
+    }
+    return &slot;
+}
+
+template <typename Req, typename Resp>
+typename RequestChannel<Req, Resp>::Reply
+RequestChannel<Req, Resp>::enqueue_locked(const Req& request) {
+    uint32_t index = free_slots.back();
+    free_slots.pop_back();
+    Slot& slot = slots[index];
+    ++slot.generation;  // Invalidates ids handed out for earlier calls
+    slot.state = SlotState::queued;
+    slot.request = request;
+    ring[(ring_head + ring_size) % ring.size()] = index;
+    ++ring_size;
+    cv_recv.notify_one();  // Notify a waiting server
+    return Reply(this, make_id(index, slot.generation));
+}
+
+template <typename Req, typename Resp>
+void RequestChannel<Req, Resp>::free_locked(uint32_t index) {
+    Slot& slot = slots[index];
+    slot.state = SlotState::free;
+    slot.request.reset();
+    slot.response.reset();
+    free_slots.push_back(index);  // Never reallocates, see constructor
+    cv_slot.notify_one();         // Notify a caller waiting for a slot
+}
+
+template <typename Req, typename Resp>
+std::optional<Resp> RequestChannel<Req, Resp>::consume_locked(Slot& slot,
+                                                              uint32_t index) {
+    std::optional<Resp> response = std::move(slot.response);
+    free_locked(index);
+    return response;
+}
+
+template <typename Req, typename Resp>
+void RequestChannel<Req, Resp>::cancel_locked(CorrelationId id) {
+    Slot* slot = find_locked(id);
+    if (!slot) {
+        return;
+    }
+    uint32_t index = static_cast<uint32_t>(id & 0xffffffffu);
+    if (slot->state == SlotState::queued) {
+        // Take it out of the request ring so the slot can be reused at once
+        size_t kept = 0;
+        for (size_t i = 0; i < ring_size; ++i) {
+            uint32_t queued = ring[(ring_head + i) % ring.size()];
+            if (queued != index) {
+                ring[(ring_head + kept++) % ring.size()] = queued;
+            }
+        }
+        ring_size = kept;
+    }
+    // A late reply is rejected by the generation check in reply()
+    free_locked(index);
+}
+
+template <typename Req, typename Resp>
+std::optional<Resp> RequestChannel<Req, Resp>::Reply::get() {
+    if (!channel) {
+        throw std::runtime_error("Reply already consumed");
+    }
+    std::unique_lock<std::mutex> lock(channel->mtx);
+    uint32_t index = static_cast<uint32_t>(id & 0xffffffffu);
+    Slot& slot = channel->slots[index];
+    slot.cv.wait(lock, [this, &slot] {
+        return slot.state == SlotState::ready || channel->closed;
+    });
+    std::optional<Resp> response;
+    if (slot.state == SlotState::ready) {
+        response = channel->consume_locked(slot, index);
+    } else {
+        channel->cancel_locked(id);
+    }
+    channel = nullptr;
+    return response;
+}
+
+template <typename Req, typename Resp>
+template <typename Rep, typename Period>
+std::optional<Resp> RequestChannel<Req, Resp>::Reply::get_for(
+    const std::chrono::duration<Rep, Period>& timeout) {
+    if (!channel) {
+        throw std::runtime_error("Reply already consumed");
+    }
+    std::unique_lock<std::mutex> lock(channel->mtx);
+    uint32_t index = static_cast<uint32_t>(id & 0xffffffffu);
+    Slot& slot = channel->slots[index];
+    slot.cv.wait_for(lock, timeout, [this, &slot] {
+        return slot.state == SlotState::ready || channel->closed;
+    });
+    std::optional<Resp> response;
+    if (slot.state == SlotState::ready) {
+        response = channel->consume_locked(slot, index);
+    } else {
+        channel->cancel_locked(id);  // Timed out or closed
+    }
+    channel = nullptr;
+    return response;
+}
+
+template <typename Req, typename Resp>
+bool RequestChannel<Req, Resp>::Reply::is_ready() const {
+    if (!channel) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(channel->mtx);
+    Slot* slot = channel->find_locked(id);
+    return slot && slot->state == SlotState::ready;
+}
+
+template <typename Req, typename Resp>
+void RequestChannel<Req, Resp>::Reply::cancel() {
+    if (!channel) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(channel->mtx);
+    channel->cancel_locked(id);
+    channel = nullptr;
+}
@@ -0,0 +1,249 @@
+#ifndef REQUEST_CHANNEL_H
+#define REQUEST_CHANNEL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A request/reply channel with a preallocated pool of reply slots.
+ *
+ * Callers send a request with call() and get back a lightweight Reply handle
+ * instead of allocating a reply Channel per call. Each outstanding call owns
+ * one slot of a fixed pool; the slot index together with a generation counter
+ * forms the correlation id that servers pass back to reply(). Slots are freed
+ * when the reply is consumed, times out or is cancelled, and a late reply to
+ * a freed slot is detected by its stale generation and dropped.
+ *
+ * After construction a round trip performs no heap allocations: the request
+ * payload and the response live in the slot, and the request queue is a ring
+ * of slot indices. A round trip costs at most two wakeups, one for the server
+ * and one for the caller, who is woken on its own slot's condition variable.
+ *
+ * @tparam Req The type of the requests.
+ * @tparam Resp The type of the responses.
+ */
+template <typename Req, typename Resp>
+class RequestChannel {
+   public:
+    using CorrelationId = uint64_t;
+
+    /**
+     * @brief A request as seen by the server.
+     */
+    struct Request {
+        CorrelationId id;
+        Req payload;
+    };
+
+    /**
+     * @brief The caller's handle to the pending reply of a call.
+     *
+     * A Reply is move-only. Destroying a Reply that was not consumed cancels
+     * the call and frees its slot.
+     */
+    class Reply {
+       public:
+        Reply() = default;
+        Reply(const Reply&) = delete;
+        Reply& operator=(const Reply&) = delete;
+        Reply(Reply&& other) noexcept { *this = std::move(other); }
+        Reply& operator=(Reply&& other) noexcept {
+            if (this != &other) {
+                cancel();
+                channel = other.channel;
+                id = other.id;
+                other.channel = nullptr;
+            }
+            return *this;
+        }
+        ~Reply() { cancel(); }
+
+        /**
+         * @brief Waits for the response and frees the slot.
+         * @return The response, or std::nullopt if the channel was closed
+         * before the server replied.
+         * @throws std::runtime_error if the reply was already consumed.
+         */
+        std::optional<Resp> get();
+
+        /**
+         * @brief Waits for the response for at most the given duration. On
+         * timeout the call is cancelled and its slot freed.
+         * @return The response, or std::nullopt on timeout or close.
+         * @throws std::runtime_error if the reply was already consumed.
+         */
+        template <typename Rep, typename Period>
+        std::optional<Resp> get_for(
+            const std::chrono::duration<Rep, Period>& timeout);
+
+        /**
+         * @brief Checks if the response has arrived.
+         */
+        bool is_ready() const;
+
+        /**
+         * @brief Abandons the call and frees its slot. A reply sent by the
+         * server afterwards is dropped.
+         */
+        void cancel();
+
+        /**
+         * @brief Checks if the handle still refers to an outstanding call.
+         */
+        bool valid() const { return channel != nullptr; }
+
+        /**
+         * @brief Returns the correlation id of the call.
+         */
+        CorrelationId correlation_id() const { return id; }
+
+       private:
+        friend class RequestChannel;
+        Reply(RequestChannel* channel, CorrelationId id)
+            : channel(channel), id(id) {}
+
+        RequestChannel* channel = nullptr;
+        CorrelationId id = 0;
+    };
+
+    /**
+     * @brief Constructs a RequestChannel object.
+     * @param max_outstanding The number of reply slots, i.e. the maximum
+     * number of calls in flight. Must be greater than 0.
+     *
+     * Use Case: RPC between threads without allocating a reply channel per
+     * call.
+     * Example: RequestChannel<Query, Result> rpc(64);
+     */
+    explicit RequestChannel(size_t max_outstanding);
+
+    // Disable copying and moving
+    RequestChannel(const RequestChannel&) = delete;
+    RequestChannel& operator=(const RequestChannel&) = delete;
+    RequestChannel(RequestChannel&&) = delete;
+    RequestChannel& operator=(RequestChannel&&) = delete;
+
+    // Destructor
+    ~RequestChannel() { close(); }
+
+    /**
+     * @brief Sends a request. Blocks while all reply slots are in use.
+     * @param request The request to send.
+     * @return A handle to the pending reply.
+     * @throws std::runtime_error if the channel is closed.
+     *
+     * Example: auto reply = rpc.call(query);
+     *          if (auto result = reply.get()) { use(*result); }
+     */
+    Reply call(const Req& request);
+
+    /**
+     * @brief Attempts to send a request without blocking.
+     * @return A handle to the pending reply, or std::nullopt if no reply slot
+     * is free or the channel is closed.
+     */
+    std::optional<Reply> try_call(const Req& request);
+
+    /**
+     * @brief Receives the next request (server side). Blocks while there is
+     * none.
+     * @return The request, or std::nullopt if the channel is closed.
+     */
+    std::optional<Request> receive();
+
+    /**
+     * @brief Delivers the response to a request (server side).
+     * @param id The correlation id of the request.
+     * @param response The response.
+     * @return true if the caller is still waiting, false if the call was
+     * cancelled, timed out or the channel was closed.
+     */
+    bool reply(CorrelationId id, const Resp& response);
+
+    /**
+     * @brief Closes the channel. Pending calls return std::nullopt and
+     * blocked servers are woken up.
+     */
+    void close();
+
+    /**
+     * @brief Checks if the channel is closed.
+     */
+    bool is_closed() const {
+        std::unique_lock<std::mutex> lock(mtx);
+        return closed;
+    }
+
+    /**
+     * @brief Returns the number of calls in flight.
+     */
+    size_t outstanding() const {
+        std::unique_lock<std::mutex> lock(mtx);
+        return slots.size() - free_slots.size();
+    }
+
+   private:
+    enum class SlotState { free, queued, in_service, ready };
+
+    struct Slot {
+        SlotState state = SlotState::free;
+        uint32_t generation = 0;
+        std::optional<Req> request;
+        std::optional<Resp> response;
+        std::condition_variable cv;  // The caller waiting on this slot
+    };
+
+    static CorrelationId make_id(uint32_t index, uint32_t generation) {
+        return (static_cast<CorrelationId>(generation) << 32) | index;
+    }
+
+    /**
+     * @brief Returns the slot for a correlation id, or nullptr if the id is
+     * stale. Must be called with mtx held.
+     */
+    Slot* find_locked(CorrelationId id);
+
+    /**
+     * @brief Queues a request in a free slot. Must be called with mtx held
+     * and at least one slot free.
+     */
+    Reply enqueue_locked(const Req& request);
+
+    /**
+     * @brief Returns a slot to the pool. Must be called with mtx held.
+     */
+    void free_locked(uint32_t index);
+
+    /**
+     * @brief Takes the response out of a ready slot and frees it. Must be
+     * called with mtx held.
+     */
+    std::optional<Resp> consume_locked(Slot& slot, uint32_t index);
+
+    /**
+     * @brief Cancels a call, removing it from the request ring if no server
+     * has picked it up yet. Must be called with mtx held.
+     */
+    void cancel_locked(CorrelationId id);
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;  // Stack of free slot indices
+    std::vector<uint32_t> ring;        // Queued slot indices
+    size_t ring_head = 0;
+    size_t ring_size = 0;
+
+    mutable std::mutex mtx;
+    std::condition_variable cv_recv;  // Servers waiting for requests
+    std::condition_variable cv_slot;  // Callers waiting for a free slot
+    bool closed = false;
+};
+
+#include "request_channel.cc"
+
+#endif  // REQUEST_CHANNEL_H
@@ -0,0 +1,131 @@
+#include "request_channel.h"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+void test_round_trip() {
+    log("Testing request/reply round trips");
+    RequestChannel<int, int> rpc(4);
+
+    std::thread server([&rpc] {
+        while (auto request = rpc.receive()) {
+            rpc.reply(request->id, request->payload * 2);
+        }
+        log("Server stopped");
+    });
+
+    const int num_callers = 3;
+    const int calls_per_caller = 1000;
+    std::vector<std::thread> callers;
+    for (int c = 0; c < num_callers; ++c) {
+        callers.emplace_back([&rpc, c] {
+            for (int i = 0; i < calls_per_caller; ++i) {
+                int value = c * calls_per_caller + i;
+                auto reply = rpc.call(value);
+                auto response = reply.get();
+                assert(response && *response == value * 2 &&
+                       "Reply delivered to the wrong caller");
+                assert(!reply.valid() && "Reply should be consumed");
+            }
+        });
+    }
+    for (auto& t : callers) t.join();
+    assert(rpc.outstanding() == 0 && "All slots should be free again");
+
+    rpc.close();
+    server.join();
+    log("Round trip test completed");
+}
+
+void test_timeout_and_late_reply() {
+    log("Testing timeout and late reply");
+    RequestChannel<std::string, std::string> rpc(1);
+
+    auto reply = rpc.call("slow");
+    auto request = rpc.receive();
+    assert(request && request->payload == "slow");
+
+    auto response = reply.get_for(std::chrono::milliseconds(20));
+    assert(!response && "Call should time out");
+    assert(rpc.outstanding() == 0 && "Timeout should free the slot");
+
+    // The slot is reused by the next call; the late reply must be dropped
+    auto next = rpc.call("fast");
+    assert(!rpc.reply(request->id, "late") && "Stale reply was accepted");
+    auto next_request = rpc.receive();
+    assert(next_request->id != request->id &&
+           "Correlation id should change on reuse");
+    assert(rpc.reply(next_request->id, "ok"));
+    assert(*next.get() == "ok");
+    log("Timeout and late reply test completed");
+}
+
+void test_cancel_and_slot_exhaustion() {
+    log("Testing cancellation and slot exhaustion");
+    RequestChannel<int, int> rpc(2);
+
+    auto a = rpc.call(1);
+    auto b = rpc.call(2);
+    assert(!rpc.try_call(3) && "No slot should be free");
+
+    // Cancel a call that the server has not picked up yet
+    a.cancel();
+    assert(!a.valid());
+    {
+        auto c = rpc.try_call(3);
+        assert(c && "Cancelled slot should be reusable");
+        // Dropping the handle cancels the call as well
+    }
+
+    auto request = rpc.receive();
+    assert(request && request->payload == 2 &&
+           "Cancelled requests should be skipped");
+    assert(rpc.reply(request->id, 20));
+    assert(b.is_ready() && *b.get() == 20);
+    assert(rpc.outstanding() == 0);
+    log("Cancellation test completed");
+}
+
+void test_close() {
+    log("Testing close with pending calls");
+    RequestChannel<int, int> rpc(1);
+
+    auto reply = rpc.call(1);
+    std::thread blocked_caller([&rpc] {
+        try {
+            rpc.call(2);  // Blocks, all slots in use
+            assert(false && "Expected exception was not thrown");
+        } catch (const std::runtime_error& e) {
+            log("Caught expected exception: " + std::string(e.what()));
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    rpc.close();
+    blocked_caller.join();
+
+    assert(!reply.get() && "Pending call should be abandoned on close");
+    assert(!rpc.receive() && "Server should see the channel closed");
+    log("Close test completed");
+}
+
+int main() {
+    log("Starting RequestChannel tests");
+
+    test_round_trip();
+    test_timeout_and_late_reply();
+    test_cancel_and_slot_exhaustion();
+    test_close();
+
+    log("All tests completed successfully");
+    return 0;
+}
@@ -0,0 +1,589 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "channel_memory.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace detail {
+
+// Copies of at least this many bytes bypass the cache, since the data would
+// evict the working set of both threads before the consumer gets to it.
+constexpr size_t kStreamingCopyThreshold = size_t(1) << 20;
+
+/**
+ * @brief Copies bytes into the ring. Large copies use non-temporal stores
+ * when SSE2 is available and plain memcpy otherwise.
+ */
+inline void copy_into_ring(void* dst, const void* src, size_t bytes) {
+#if defined(__SSE2__)
+    if (bytes >= kStreamingCopyThreshold) {
+        auto* d = static_cast<char*>(dst);
+        auto* s = static_cast<const char*>(src);
+        // Bring the destination to a 16-byte boundary
+        size_t head = (16 - reinterpret_cast<uintptr_t>(d) % 16) % 16;
+        std::memcpy(d, s, head);
+        d += head;
+        s += head;
+        bytes -= head;
+        for (; bytes >= 64; bytes -= 64, d += 64, s += 64) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+            __m128i b =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+            __m128i c =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+            __m128i e =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+        }
+        std::memcpy(d, s, bytes);
+        // Streaming stores are weakly ordered; publish them before the
+        // release store of the tail
+        _mm_sfence();
+        return;
+    }
+#endif
+    std::memcpy(dst, src, bytes);
+}
+
+/**
+ * @brief Fixed-capacity ring of preallocated slots used as Channel storage.
+ *
+ * The read (head) and write (tail) positions are free-running atomic
+ * counters on separate cache lines, so a single producer and a single
+ * consumer can use the ring concurrently without a lock: the producer only
+ * writes tail, the consumer only writes head. When several producers or
+ * consumers share the ring, the channel serializes them with its mutex.
+ *
+ * Bulk pushes and pops copy at most two contiguous segments per call, with
+ * memcpy when T is trivially copyable.
+ *
+ * With a non-zero Extent the slots are embedded in the object instead of
+ * allocated, the capacity is a compile-time constant, and positions wrap
+ * with a mask when Extent is a power of two. A runtime-sized ring places its
+ * slots according to the StorageOptions it is constructed with.
+ *
+ * @tparam T The type of the elements.
+ * @tparam Extent The fixed capacity, or 0 for a capacity chosen at runtime.
+ */
+template <typename T, size_t Extent = 0>
+class RingBuffer {
+   public:
+    explicit RingBuffer(
+        size_t capacity = Extent, const StorageOptions& options = {},
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : cap(capacity), slots(make_slots(capacity, options, resource)) {}
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    ~RingBuffer() {
+        while (!empty()) {
+            pop();
+        }
+    }
+
+    size_t capacity() const {
+        if constexpr (kStatic) {
+            return Extent;
+        } else {
+            return cap;
+        }
+    }
+
+    /**
+     * @brief Returns the number of elements. Exact when called by the
+     * producer or consumer, a snapshot otherwise.
+     */
+    size_t size() const {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_acquire);
+        return std::min(t - h, capacity());
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_relaxed) ==
+               tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Checks if every slot holds an element. Safe to call while other
+     * threads push and pop: a true answer held when head was read.
+     */
+    bool full() const {
+        // Tail first, so later pushes can only make the ring look emptier.
+        // If pops overtook the loaded tail, t - h wraps around and the ring
+        // was not full either.
+        size_t t = tail.load(std::memory_order_acquire);
+        size_t h = head.load(std::memory_order_acquire);
+        return t - h == capacity();
+    }
+
+    // The cache lines a polling waiter watches for the peer's progress
+    const void* head_address() const { return &head; }
+    const void* tail_address() const { return &tail; }
+
+    /**
+     * @brief Called by consumers before they read, to apply
+     * NumaPlacement::consumer_local.
+     */
+    void adopt_consumer_node() {
+        if constexpr (!kStatic) {
+            slots.adopt_consumer_node();
+        }
+    }
+
+    /**
+     * @brief Appends an element. The ring must not be full.
+     */
+    template <typename U>
+    void push(U&& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        new (slot(t)) T(std::forward<U>(value));
+        tail.store(t + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Removes and returns the oldest element. The ring must not be
+     * empty.
+     */
+    T pop() {
+        size_t h = head.load(std::memory_order_relaxed);
+        T* element = slot(h);
+        T value = std::move(*element);
+        element->~T();
+        head.store(h + 1, std::memory_order_release);
+        return value;
+    }
+
+    /**
+     * @brief Appends count elements. The ring must have room for them.
+     */
+    void push_n(const T* values, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t first = std::min(count, capacity() - index(t));
+        copy_in(slot(t), values, first);
+        copy_in(slot(t + first), values + first, count - first);
+        tail.store(t + count, std::memory_order_release);
+    }
+
+    /**
+     * @brief Moves the count oldest elements to out. The ring must hold at
+     * least count elements.
+     */
+    void pop_n(T* out, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t first = std::min(count, capacity() - index(h));
+        move_out(out, slot(h), first);
+        move_out(out + first, slot(h + first), count - first);
+        head.store(h + count, std::memory_order_release);
+    }
+
+   private:
+    using Slot = std::aligned_storage_t<sizeof(T), alignof(T)>;
+    using Slots = std::conditional_t<Extent != 0, std::array<Slot, Extent>,
+                                     SlotArray<Slot>>;
+
+    static constexpr bool kStatic = Extent != 0;
+    static constexpr bool kPowerOfTwo = kStatic && (Extent & (Extent - 1)) == 0;
+
+    static Slots make_slots(
+        [[maybe_unused]] size_t capacity,
+        [[maybe_unused]] const StorageOptions& options,
+        [[maybe_unused]] std::pmr::memory_resource* resource) {
+        if constexpr (kStatic) {
+            return Slots();
+        } else {
+            return Slots(capacity, options, resource);
+        }
+    }
+
+    size_t index(size_t position) const {
+        if constexpr (kPowerOfTwo) {
+            return position & (Extent - 1);
+        } else {
+            return position % capacity();
+        }
+    }
+
+    T* slot(size_t position) {
+        return std::launder(reinterpret_cast<T*>(&slots[index(position)]));
+    }
+
+    // Copies into consecutive free slots
+    static void copy_in(T* dst, const T* src, size_t count) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            copy_into_ring(dst, src, count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                new (dst + i) T(src[i]);
+            }
+        }
+    }
+
+    // Moves out of consecutive occupied slots, leaving them free
+    static void move_out(T* dst, T* src, size_t count) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memcpy(dst, src, count * sizeof(T));
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                dst[i] = std::move(src[i]);
+                src[i].~T();
+            }
+        }
+    }
+
+    const size_t cap;
+    Slots slots;
+    alignas(64) std::atomic<size_t> head{0};  // Next position to read
+    alignas(64) std::atomic<size_t> tail{0};  // Next position to write
+};
+
+/**
+ * @brief An element count written by one thread at a time, under a lock,
+ * and readable by any thread without it.
+ *
+ * Updates are a plain load and store rather than a read-modify-write, so
+ * they cost what a size_t does.
+ */
+class LockedCount {
+   public:
+    operator size_t() const { return value.load(std::memory_order_relaxed); }
+
+    LockedCount& operator=(size_t n) {
+        value.store(n, std::memory_order_relaxed);
+        return *this;
+    }
+    LockedCount& operator++() { return *this = *this + 1; }
+    LockedCount& operator--() { return *this = *this - 1; }
+
+   private:
+    std::atomic<size_t> value{0};
+};
+
+/**
+ * @brief Growable FIFO used as Channel storage when the capacity is not
+ * fixed up front.
+ *
+ * A power-of-two ring that doubles when full and never shrinks, so once it
+ * has grown to the peak number of queued elements, or was reserved for it,
+ * pushes and pops no longer allocate. Like RingBuffer, bulk pushes and pops
+ * of a trivially copyable T copy at most two contiguous segments.
+ *
+ * @tparam T The type of the elements.
+ */
+template <typename T>
+class QueueBuffer {
+   public:
+    explicit QueueBuffer(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : resource(resource) {}
+
+    QueueBuffer(const QueueBuffer&) = delete;
+    QueueBuffer& operator=(const QueueBuffer&) = delete;
+
+    ~QueueBuffer() {
+        while (!empty()) {
+            pop();
+        }
+        release(slots, cap);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /**
+     * @brief Makes room for at least n elements without further allocation.
+     * @throws std::length_error if n elements cannot be addressed.
+     */
+    void reserve(size_t n) {
+        if (n > cap) {
+            if (n > kMaxCapacity) {
+                throw std::length_error("Channel buffer too large");
+            }
+            size_t grown = kMinCapacity;
+            while (grown < n) {
+                grown *= 2;
+            }
+            regrow(grown);
+        }
+    }
+
+    template <typename U>
+    void push(U&& value) {
+        if (count == cap) {
+            regrow(cap ? 2 * cap : kMinCapacity);
+        }
+        new (slot(head + count)) T(std::forward<U>(value));
+        ++count;
+    }
+
+    T pop() {
+        T* element = slot(head);
+        T value = std::move(*element);
+        element->~T();
+        head = (head + 1) & (cap - 1);
+        --count;
+        return value;
+    }
+
+    void push_n(const T* values, size_t n) {
+        if (n == 0) {
+            return;
+        }
+        reserve(count + n);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            size_t start = (head + count) & (cap - 1);
+            size_t first = std::min(n, cap - start);
+            copy_into_ring(slot(start), values, first * sizeof(T));
+            copy_into_ring(slot(0), values + first, (n - first) * sizeof(T));
+            count = count + n;
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                push(values[i]);
+            }
+        }
+    }
+
+    void pop_n(T* out, size_t n) {
+        if (n == 0) {
+            return;
+        }
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            size_t first = std::min(n, cap - head);
+            std::memcpy(out, slot(head), first * sizeof(T));
+            std::memcpy(out + first, slot(0), (n - first) * sizeof(T));
+            head = (head + n) & (cap - 1);
+            count = count - n;
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = pop();
+            }
+        }
+    }
+
+   private:
+    using Slot = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+    static constexpr size_t kMinCapacity = 16;
+    // Rounding up to a power of two at most doubles this, which still fits
+    // in size_t bytes
+    static constexpr size_t kMaxCapacity =
+        std::numeric_limits<size_t>::max() / sizeof(Slot) / 2;
+
+    T* slot(size_t position) {
+        return std::launder(
+            reinterpret_cast<T*>(&slots[position & (cap - 1)]));
+    }
+
+    void release(Slot* array, size_t n) {
+        if (array) {
+            resource->deallocate(array, n * sizeof(Slot), alignof(Slot));
+        }
+    }
+
+    // Moves the elements into a ring of grown slots, unwrapping it so head
+    // starts at 0
+    void regrow(size_t grown) {
+        auto* fresh = static_cast<Slot*>(
+            resource->allocate(grown * sizeof(Slot), alignof(Slot)));
+        T* dst = std::launder(reinterpret_cast<T*>(fresh));
+        size_t moved = 0;
+        try {
+            for (; moved < count; ++moved) {
+                new (dst + moved) T(std::move_if_noexcept(*slot(head + moved)));
+            }
+        } catch (...) {
+            for (size_t i = 0; i < moved; ++i) {
+                dst[i].~T();
+            }
+            release(fresh, grown);
+            throw;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            slot(head + i)->~T();
+        }
+        release(slots, cap);
+        slots = fresh;
+        cap = grown;
+        head = 0;
+    }
+
+    std::pmr::memory_resource* resource;
+    Slot* slots = nullptr;
+    size_t cap = 0;  // Zero or a power of two
+    size_t head = 0;
+    LockedCount count;  // Read by size() and empty() without the lock
+};
+
+/**
+ * @brief Growable FIFO for large elements: the elements live in a slab of
+ * recycled slots and only their 4-byte slot indices pass through the queue.
+ *
+ * Growing a ring of large elements moves every one of them, and the ring
+ * itself spans many pages. Here slots never move and a freed slot is reused
+ * by the next push, so once the slab has grown to the peak number of queued
+ * elements, pushes and pops no longer allocate, and the index queue stays a
+ * few cache lines long.
+ *
+ * @tparam T The type of the elements.
+ */
+template <typename T>
+class SlabBuffer {
+   public:
+    explicit SlabBuffer(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : chunks(resource), free_slots(resource), order(resource) {}
+    SlabBuffer(const SlabBuffer&) = delete;
+    SlabBuffer& operator=(const SlabBuffer&) = delete;
+
+    ~SlabBuffer() {
+        while (!empty()) {
+            pop();
+        }
+        for (Slot* chunk : chunks) {
+            resource()->deallocate(chunk, sizeof(Slot) * kChunkSize,
+                                   alignof(Slot));
+        }
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /**
+     * @brief Makes room for at least n elements without further allocation.
+     * @throws std::length_error if n exceeds the 32-bit slot indices.
+     */
+    void reserve(size_t n) {
+        if (n > std::numeric_limits<uint32_t>::max()) {
+            throw std::length_error("Channel buffer too large");
+        }
+        while (chunks.size() * kChunkSize < n) {
+            grow_slab();
+        }
+        while (order.size() < n) {
+            grow_order();
+        }
+    }
+
+    template <typename U>
+    void push(U&& value) {
+        if (free_slots.empty()) {
+            grow_slab();
+        }
+        uint32_t index = free_slots.back();
+        new (slot(index)) T(std::forward<U>(value));
+        free_slots.pop_back();
+        if (count == order.size()) {
+            grow_order();
+        }
+        order[(head + count) & (order.size() - 1)] = index;
+        ++count;
+    }
+
+    T pop() {
+        uint32_t index = order[head];
+        head = (head + 1) & (order.size() - 1);
+        --count;
+        T* element = slot(index);
+        T value = std::move(*element);
+        element->~T();
+        free_slots.push_back(index);
+        return value;
+    }
+
+    void push_n(const T* values, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            push(values[i]);
+        }
+    }
+
+    void pop_n(T* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = pop();
+        }
+    }
+
+   private:
+    using Slot = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+    static constexpr uint32_t kChunkShift = 6;  // 64 slots per chunk
+    static constexpr uint32_t kChunkSize = uint32_t(1) << kChunkShift;
+
+    std::pmr::memory_resource* resource() const {
+        return chunks.get_allocator().resource();
+    }
+
+    T* slot(uint32_t index) {
+        return std::launder(reinterpret_cast<T*>(
+            &chunks[index >> kChunkShift][index & (kChunkSize - 1)]));
+    }
+
+    // Adds a chunk of slots; slots never move, so chunks are never
+    // reallocated. free_slots is sized for every slot, so pop() never
+    // reallocates it.
+    void grow_slab() {
+        uint32_t first = static_cast<uint32_t>(chunks.size()) * kChunkSize;
+        free_slots.reserve(first + kChunkSize);
+        chunks.reserve(chunks.size() + 1);
+        chunks.push_back(static_cast<Slot*>(resource()->allocate(
+            sizeof(Slot) * kChunkSize, alignof(Slot))));
+        for (uint32_t i = kChunkSize; i > 0; --i) {
+            free_slots.push_back(first + i - 1);  // Lowest index on top
+        }
+    }
+
+    // Doubles the index ring, unwrapping it so head starts at 0
+    void grow_order() {
+        std::pmr::vector<uint32_t> grown(
+            std::max<size_t>(kChunkSize, 2 * order.size()), resource());
+        for (size_t i = 0; i < count; ++i) {
+            grown[i] = order[(head + i) & (order.size() - 1)];
+        }
+        order = std::move(grown);
+        head = 0;
+    }
+
+    std::pmr::vector<Slot*> chunks;
+    std::pmr::vector<uint32_t> free_slots;  // Stack of free slot indices
+    std::pmr::vector<uint32_t> order;  // Power-of-two ring of queued indices
+    size_t head = 0;
+    LockedCount count;  // Read by size() and empty() without the lock
+};
+
+// Elements larger than a cache line are kept in a SlabBuffer rather than
+// inline in a QueueBuffer; channel_bench shows the slab ahead from there on
+constexpr size_t kMaxInlineElementSize = 64;
+
+/**
+ * @brief The growable storage for T: inline for small elements, slab-backed
+ * for large ones.
+ */
+template <typename T>
+using GrowableBuffer =
+    std::conditional_t<(sizeof(T) > kMaxInlineElementSize), SlabBuffer<T>,
+                       QueueBuffer<T>>;
+
+}  // namespace detail
+
+#endif  // RING_BUFFER_H
@@ -62,7 +62,32 @@ void consumer(Channel<int>& ch_int, Channel<std::string>& ch_str,
     assert(str_count == 20 && "Incorrect number of string messages received");
 }
 
+void test_select_cancellation() {
+    log("Testing select cancellation");
+    Channel<int> ch(1);
+    Selector selector;
+    int received = 0;
+    selector.add_receive<int>(ch, [&received](int) { received++; });
+
+    CancellationToken token;
+    bool completed = true;
+    std::thread select_thread(
+        [&selector, &token, &completed] { completed = selector.select(token); });
+
+    ch.send(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    token.cancel();
+    select_thread.join();
+
+    assert(!completed && "select() should report cancellation");
+    assert(received == 1 && "Value sent before cancellation was lost");
+    assert(!ch.is_closed() && "Cancellation must not close the channel");
+    log("Select cancellation test completed");
+}
+
 int main() {
+    test_select_cancellation();
+
     Channel<int> ch_int(5);
     Channel<std::string> ch_str(5);
 
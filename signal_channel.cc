@@ -0,0 +1,137 @@
+#include "signal_channel.h"
+
+template <typename Policy>
+void Channel<void, Policy>::notify(size_t n) {
+    size_t current = state.load(std::memory_order_relaxed);
+    do {
+        if (current & kClosed) {
+            throw std::runtime_error("Notify on closed channel");
+        }
+        // The count must not carry into the closed bit
+        if (n > ~kClosed - current) {
+            throw std::overflow_error("Too many pending signals");
+        }
+    } while (!state.compare_exchange_weak(current, current + n,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed));
+    // Pairs with wait_slow() counting itself as a waiter before it checks
+    // the state: either it sees the signals or we see it waiting
+    bool wake = waiters.load(std::memory_order_seq_cst) > 0;
+    if (wake || selectorCount.load(std::memory_order_seq_cst) > 0) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (wake) {
+            if (n == 1) {
+                cv.notify_one();  // One signal satisfies one waiter
+            } else {
+                cv.notify_all();
+            }
+        }
+        notify_selectors();
+    }
+}
+
+template <typename Policy>
+bool Channel<void, Policy>::wait() {
+    return try_wait() || wait_slow(nullptr) == ChannelStatus::ok;
+}
+
+template <typename Policy>
+bool Channel<void, Policy>::try_wait() {
+    return take() == ChannelStatus::ok;
+}
+
+template <typename Policy>
+template <typename Rep, typename Period>
+ChannelStatus Channel<void, Policy>::wait_for(
+    const std::chrono::duration<Rep, Period>& timeout) {
+    if (try_wait()) {
+        return ChannelStatus::ok;
+    }
+    Clock::time_point deadline =
+        Clock::now() + std::chrono::duration_cast<Clock::duration>(timeout);
+    return wait_slow(&deadline);
+}
+
+template <typename Policy>
+void Channel<void, Policy>::close() {
+    state.fetch_or(kClosed, std::memory_order_seq_cst);
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.notify_all();  // Waiters drain the remaining signals, then fail
+    notify_selectors();
+}
+
+template <typename Policy>
+ChannelStatus Channel<void, Policy>::take() {
+    size_t current = state.load(std::memory_order_seq_cst);
+    while ((current & ~kClosed) != 0) {
+        if (state.compare_exchange_weak(current, current - 1,
+                                        std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+            return ChannelStatus::ok;
+        }
+    }
+    // No signal can arrive once the channel is closed
+    return (current & kClosed) ? ChannelStatus::closed : ChannelStatus::empty;
+}
+
+template <typename Policy>
+ChannelStatus Channel<void, Policy>::wait_slow(
+    const Clock::time_point* deadline) {
+    std::unique_lock<std::mutex> lock(mtx);
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+    ChannelStatus status = ChannelStatus::timeout;
+    auto done = [this, &status] {
+        ChannelStatus taken = take();
+        if (taken == ChannelStatus::empty) {
+            return false;
+        }
+        status = taken;
+        return true;
+    };
+    if (deadline) {
+        cv.wait_until(lock, *deadline, done);
+    } else {
+        cv.wait(lock, done);
+    }
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+    return status;
+}
+
+template <typename Policy>
+void Channel<void, Policy>::notify_selectors() {
+    for (auto selector : selectors) {
+        selector->notify();
+    }
+}
+
+template <typename Policy>
+void Channel<void, Policy>::register_selector(Selector* selector) {
+    std::unique_lock<std::mutex> lock(mtx);
+    selectors.push_back(selector);
+    selectorCount.fetch_add(1, std::memory_order_seq_cst);
+}
+
+template <typename Policy>
+void Channel<void, Policy>::unregister_selector(Selector* selector) {
+    std::unique_lock<std::mutex> lock(mtx);
+    selectors.erase(std::remove(selectors.begin(), selectors.end(), selector),
+                    selectors.end());
+    selectorCount.store(selectors.size(), std::memory_order_relaxed);
+}
+
+template <typename Policy, typename Callback>
+void Selector::add_receive(Channel<void, Policy>& ch, Callback callback) {
+    std::unique_lock<std::mutex> lock(mtx);
+    ch.register_selector(this);
+    auto poll = [&ch, callback = std::move(callback), this]() mutable {
+        while (ch.try_wait()) {
+            callback();  // Once per signal
+        }
+        if (ch.is_closed() && ch.is_empty()) {
+            ch.unregister_selector(this);
+            return true;  // Signal that this channel is done
+        }
+        return false;
+    };
+    channels.emplace_back(std::move(poll), channels.get_allocator().resource());
+}
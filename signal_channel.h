@@ -0,0 +1,164 @@
+#ifndef SIGNAL_CHANNEL_H
+#define SIGNAL_CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "channel.h"
+
+/**
+ * @brief A channel that carries no values, only a count of pending signals.
+ *
+ * Where a Channel<bool> used as a wakeup keeps a queue of dummy values, a
+ * signal channel keeps a single atomic counter. notify() adds to it with one
+ * atomic operation and only takes the lock to wake a thread when one is
+ * waiting; each wait() takes one signal. Signals are never lost or merged:
+ * notify(3) lets three waits return. There is no capacity, so notify()
+ * never blocks.
+ *
+ * Closing the channel fails further notifies, while the signals sent before
+ * close() can still be taken; wait() returns false once none are left.
+ *
+ * @tparam Policy Accepted so signal channels can be declared like any other
+ * channel. Producer and consumer cardinality, storage and wait strategy do
+ * not apply: the counter is shared by any number of threads and waiters
+ * block on a condition variable.
+ */
+template <typename Policy>
+class Channel<void, Policy> {
+   public:
+    using policy_type = Policy;
+
+    /**
+     * @brief Constructs a signal channel with no pending signals.
+     * @param resource Supplies the list of registered selectors. Must
+     * outlive the channel.
+     *
+     * Use Case: Wake a worker when there is new work, without a payload.
+     * Example: SignalChannel wakeup;
+     */
+    explicit Channel(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : selectors(resource) {}
+
+    // Disable copying and moving
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+    Channel(Channel&&) = delete;
+    Channel& operator=(Channel&&) = delete;
+
+    // Destructor
+    ~Channel() { close(); }
+
+    /**
+     * @brief Sends n signals. Never blocks. At most SIZE_MAX / 2 signals
+     * can be pending at once.
+     * @param n The number of signals.
+     * @throws std::runtime_error if the channel is closed.
+     * @throws std::overflow_error if the pending signals would exceed the
+     * limit. No signals are sent.
+     *
+     * Use Case: Tell a pool of workers how many jobs were queued.
+     * Example: wakeup.notify(jobs.size());
+     */
+    void notify(size_t n = 1);
+
+    /**
+     * @brief Takes one signal, blocking until one is available.
+     * @return true if a signal was taken, false if the channel is closed and
+     * no signals are left.
+     *
+     * Example: while (wakeup.wait()) { process_queue(); }
+     */
+    bool wait();
+
+    /**
+     * @brief Takes one signal if one is pending, without blocking.
+     * @return true if a signal was taken.
+     */
+    bool try_wait();
+
+    /**
+     * @brief Takes one signal, waiting at most the given duration.
+     * @return ChannelStatus::ok, closed (closed and no signals left) or
+     * timeout.
+     *
+     * Example: if (wakeup.wait_for(std::chrono::milliseconds(100)) ==
+     *              ChannelStatus::timeout) { flush(); }
+     */
+    template <typename Rep, typename Period>
+    ChannelStatus wait_for(const std::chrono::duration<Rep, Period>& timeout);
+
+    /**
+     * @brief Closes the channel. Blocked waiters take the remaining signals
+     * and then return false.
+     */
+    void close();
+
+    bool is_closed() const {
+        return (state.load(std::memory_order_acquire) & kClosed) != 0;
+    }
+    bool is_empty() const { return size() == 0; }
+
+    /**
+     * @brief Returns the number of pending signals.
+     */
+    size_t size() const {
+        return state.load(std::memory_order_acquire) & ~kClosed;
+    }
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    // The top bit of state marks the channel closed; the rest counts the
+    // pending signals, so notify() and close() cannot interleave.
+    static constexpr size_t kClosed =
+        ~(std::numeric_limits<size_t>::max() >> 1);
+
+    /**
+     * @brief Takes one signal if one is pending.
+     * @return ChannelStatus::ok, closed if the channel is closed and no
+     * signals are left, or empty.
+     */
+    ChannelStatus take();
+
+    /**
+     * @brief Blocks until a signal is taken, the channel is closed and
+     * drained, or the deadline passes.
+     * @param deadline The deadline, or nullptr to wait indefinitely.
+     * @return ChannelStatus::ok, closed or timeout.
+     */
+    ChannelStatus wait_slow(const Clock::time_point* deadline);
+
+    /**
+     * @brief Notifies all registered selectors. Must be called with mtx
+     * held.
+     */
+    void notify_selectors();
+
+    void register_selector(Selector* selector);
+    void unregister_selector(Selector* selector);
+
+    std::atomic<size_t> state{0};
+    // Threads blocked in wait(); notify() only locks mtx when this is not 0
+    std::atomic<size_t> waiters{0};
+    std::atomic<size_t> selectorCount{0};
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    friend class Selector;
+    std::pmr::vector<Selector*> selectors;
+};
+
+// A channel of bare wakeup signals
+using SignalChannel = Channel<void>;
+
+#include "signal_channel.cc"
+
+#endif  // SIGNAL_CHANNEL_H
@@ -0,0 +1,172 @@
+#include "signal_channel.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+void test_counting() {
+    log("Testing signal counting");
+    SignalChannel signals;
+    assert(signals.is_empty() && !signals.try_wait());
+    signals.notify(3);
+    signals.notify();
+    assert(signals.size() == 4);
+    for (int i = 0; i < 4; ++i) {
+        assert(signals.try_wait());
+    }
+    assert(!signals.try_wait() && signals.is_empty());
+
+    // The count cannot reach the closed bit
+    signals.notify(2);
+    try {
+        signals.notify(static_cast<size_t>(-1));
+        assert(false && "Expected exception was not thrown");
+    } catch (const std::overflow_error& e) {
+        log("Caught expected exception: " + std::string(e.what()));
+    }
+    assert(!signals.is_closed() && signals.size() == 2);
+    signals.notify();
+    assert(signals.try_wait() && signals.try_wait() && signals.try_wait());
+    assert(!signals.try_wait());
+
+    // Channel<void> is the same type
+    Channel<void> wakeup;
+    wakeup.notify();
+    assert(wakeup.wait());
+    log("Counting test completed");
+}
+
+void test_blocking_wait() {
+    log("Testing blocking waits");
+    SignalChannel signals;
+    std::atomic<bool> woken{false};
+    std::thread waiter([&] {
+        assert(signals.wait());
+        woken = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(!woken);
+    signals.notify();
+    waiter.join();
+    assert(woken && signals.is_empty());
+
+    assert(signals.wait_for(std::chrono::milliseconds(10)) ==
+           ChannelStatus::timeout);
+    std::thread notifier([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        signals.notify();
+    });
+    assert(signals.wait_for(std::chrono::seconds(5)) == ChannelStatus::ok);
+    notifier.join();
+    log("Blocking wait test completed");
+}
+
+void test_close() {
+    log("Testing close");
+    SignalChannel signals;
+    signals.notify(2);
+    signals.close();
+    bool threw = false;
+    try {
+        signals.notify();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && signals.is_closed());
+
+    // Signals sent before close() are still delivered
+    assert(signals.wait() && signals.wait());
+    assert(!signals.wait());
+    assert(signals.wait_for(std::chrono::milliseconds(10)) ==
+           ChannelStatus::closed);
+
+    // close() wakes blocked waiters
+    SignalChannel idle;
+    std::thread waiter([&] { assert(!idle.wait()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    idle.close();
+    waiter.join();
+    log("Close test completed");
+}
+
+void test_many_threads() {
+    log("Testing signals across many threads");
+    constexpr int kNotifiers = 4;
+    constexpr int kWaiters = 4;
+    constexpr int kPerNotifier = 20000;
+    SignalChannel signals;
+    std::atomic<long long> taken{0};
+    std::vector<std::thread> waiters;
+    for (int w = 0; w < kWaiters; ++w) {
+        waiters.emplace_back([&] {
+            while (signals.wait()) {
+                taken++;
+            }
+        });
+    }
+    std::vector<std::thread> notifiers;
+    for (int n = 0; n < kNotifiers; ++n) {
+        notifiers.emplace_back([&signals, n] {
+            int burst = n % 2 + 1;  // Mix single signals and bursts
+            for (int i = 0; i < kPerNotifier; i += burst) {
+                signals.notify(burst);
+            }
+        });
+    }
+    for (auto& t : notifiers) {
+        t.join();
+    }
+    signals.close();
+    for (auto& t : waiters) {
+        t.join();
+    }
+    assert(taken == kNotifiers * kPerNotifier && "Lost or duplicated signals");
+    log("Many threads test completed");
+}
+
+void test_selector() {
+    log("Testing signal channels in a selector");
+    SignalChannel signals;
+    Channel<int> values(4);
+    Selector selector;
+    int signal_count = 0;
+    int value_sum = 0;
+    selector.add_receive(signals, [&signal_count] { signal_count++; });
+    selector.add_receive(values, [&value_sum](int v) { value_sum += v; });
+    std::thread loop([&selector] { selector.select(); });
+
+    signals.notify(3);
+    values.send(5);
+    signals.notify();
+    signals.close();
+    values.close();
+    // select() returns once both channels are closed and drained
+    loop.join();
+    assert(signal_count == 4 && value_sum == 5);
+    log("Selector test completed");
+}
+
+int main() {
+    log("Starting signal channel tests");
+
+    test_counting();
+    test_blocking_wait();
+    test_close();
+    test_many_threads();
+    test_selector();
+
+    log("All tests completed successfully");
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include "topic_router.h"
+
+#include <algorithm>
+#include <utility>
+
+template <typename T>
+typename TopicRouter<T>::SubscriptionId TopicRouter<T>::subscribe(
+    const std::string& pattern, Channel<Message>& ch) {
+    std::vector<std::string> levels = split(pattern);
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const std::string& level = levels[i];
+        if (level.size() > 1 && level.find_first_of("*#") != std::string::npos) {
+            throw std::invalid_argument("Wildcards must fill a whole level");
+        }
+        if (level == "#" && i + 1 != levels.size()) {
+            throw std::invalid_argument("'#' must be the last level");
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(subs_mtx);
+    Node* node = &root;
+    for (const auto& level : levels) {
+        std::unique_ptr<Node>& next = child(*node, level);
+        if (!next) {
+            next = std::make_unique<Node>();
+        }
+        node = next.get();
+    }
+    SubscriptionId id = next_id++;
+    node->subscribers.push_back(id);
+    subscriptions.emplace(
+        id, Subscription{std::move(levels), std::make_shared<Subscriber>(ch)});
+    invalidate_cache();
+    return id;
+}
+
+template <typename T>
+bool TopicRouter<T>::unsubscribe(SubscriptionId id) {
+    std::unique_lock<std::shared_mutex> lock(subs_mtx);
+    auto it = subscriptions.find(id);
+    if (it == subscriptions.end()) {
+        return false;
+    }
+    std::shared_ptr<Subscriber> subscriber = it->second.subscriber;
+    // Walk down the trie, remembering the path so empty nodes can be pruned
+    std::vector<std::pair<Node*, const std::string*>> path;
+    Node* node = &root;
+    for (const auto& level : it->second.levels) {
+        path.emplace_back(node, &level);
+        node = child(*node, level).get();
+    }
+    auto& subs = node->subscribers;
+    subs.erase(std::remove(subs.begin(), subs.end(), id), subs.end());
+
+    for (auto step = path.rbegin(); step != path.rend(); ++step) {
+        auto& [parent, level] = *step;
+        const Node& n = *child(*parent, *level);
+        if (!n.subscribers.empty() || !n.children.empty() || n.single ||
+            n.rest) {
+            break;
+        }
+        if (*level == "*") {
+            parent->single.reset();
+        } else if (*level == "#") {
+            parent->rest.reset();
+        } else {
+            parent->children.erase(*level);
+        }
+    }
+
+    subscriptions.erase(it);
+    invalidate_cache();
+    lock.unlock();
+
+    // Publishes that looked the subscription up before it was removed may
+    // still be sending; stop new ones, interrupt blocked ones and wait.
+    // cancel() runs outside subscriber->mtx, which the sends do not hold.
+    subscriber->removed.cancel();
+    std::unique_lock<std::mutex> idle_lock(subscriber->mtx);
+    subscriber->idle.wait(idle_lock,
+                          [&subscriber] { return subscriber->in_flight == 0; });
+    return true;
+}
+
+template <typename T>
+size_t TopicRouter<T>::publish(const std::string& topic, T payload) {
+    auto matches = lookup(topic);
+    if (matches->empty()) {
+        return 0;
+    }
+    // One allocation per message, shared by every subscriber
+    Message message = std::make_shared<const TopicMessage<T>>(
+        TopicMessage<T>{topic, std::move(payload)});
+    size_t delivered = 0;
+    for (const auto& subscriber : *matches) {
+        if (deliver(*subscriber, message)) {
+            ++delivered;
+        }
+    }
+    return delivered;
+}
+
+template <typename T>
+bool TopicRouter<T>::deliver(Subscriber& subscriber, const Message& message) {
+    {
+        std::unique_lock<std::mutex> lock(subscriber.mtx);
+        if (subscriber.removed.is_cancelled()) {
+            return false;  // unsubscribe() may already be destroying it
+        }
+        ++subscriber.in_flight;
+    }
+    bool sent = false;
+    Channel<Message>& ch = *subscriber.channel;
+    if (!ch.is_closed()) {
+        try {
+            sent = ch.send(message, subscriber.removed);
+        } catch (const std::runtime_error&) {
+            // The subscriber closed its channel while we were sending
+        }
+    }
+    std::unique_lock<std::mutex> lock(subscriber.mtx);
+    if (--subscriber.in_flight == 0) {
+        subscriber.idle.notify_all();
+    }
+    return sent;
+}
+
+template <typename T>
+std::unique_ptr<typename TopicRouter<T>::Node>& TopicRouter<T>::child(
+    Node& node, const std::string& level) {
+    if (level == "*") {
+        return node.single;
+    }
+    if (level == "#") {
+        return node.rest;
+    }
+    return node.children[level];
+}
+
+template <typename T>
+std::vector<std::string> TopicRouter<T>::split(const std::string& topic) {
+    std::vector<std::string> levels;
+    size_t start = 0;
+    while (true) {
+        size_t end = topic.find('/', start);
+        levels.push_back(topic.substr(start, end - start));
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+    return levels;
+}
+
+template <typename T>
+void TopicRouter<T>::match(const Node& node,
+                           const std::vector<std::string>& levels, size_t depth,
+                           std::vector<SubscriptionId>& out) const {
+    // '#' matches everything below this point, including nothing
+    if (node.rest) {
+        out.insert(out.end(), node.rest->subscribers.begin(),
+                   node.rest->subscribers.end());
+    }
+    if (depth == levels.size()) {
+        out.insert(out.end(), node.subscribers.begin(), node.subscribers.end());
+        return;
+    }
+    auto it = node.children.find(levels[depth]);
+    if (it != node.children.end()) {
+        match(*it->second, levels, depth + 1, out);
+    }
+    if (node.single) {
+        match(*node.single, levels, depth + 1, out);
+    }
+}
+
+template <typename T>
+std::shared_ptr<const typename TopicRouter<T>::MatchList>
+TopicRouter<T>::lookup(const std::string& topic) {
+    // Held shared for the whole lookup so a concurrent subscription change
+    // cannot slip in between computing and caching the result.
+    std::shared_lock<std::shared_mutex> subs_lock(subs_mtx);
+    {
+        std::unique_lock<std::mutex> lock(cache_mtx);
+        auto it = cache.find(topic);
+        if (it != cache.end()) {
+            lru.splice(lru.begin(), lru, it->second.lru_pos);
+            ++hits;
+            return it->second.matches;
+        }
+    }
+
+    std::vector<SubscriptionId> ids;
+    match(root, split(topic), 0, ids);
+    auto matches = std::make_shared<MatchList>();
+    for (SubscriptionId id : ids) {
+        const auto& subscriber = subscriptions.at(id).subscriber;
+        bool seen = std::any_of(
+            matches->begin(), matches->end(), [&subscriber](const auto& m) {
+                return m->channel == subscriber->channel;
+            });
+        if (!seen) {
+            matches->push_back(subscriber);
+        }
+    }
+
+    if (cache_capacity > 0) {
+        std::unique_lock<std::mutex> lock(cache_mtx);
+        if (cache.count(topic) == 0) {
+            if (cache.size() >= cache_capacity) {
+                cache.erase(lru.back());
+                lru.pop_back();
+            }
+            lru.push_front(topic);
+            cache.emplace(topic, CacheEntry{matches, lru.begin()});
+        }
+    }
+    return matches;
+}
+
+template <typename T>
+void TopicRouter<T>::invalidate_cache() {
+    std::unique_lock<std::mutex> lock(cache_mtx);
+    cache.clear();
+    lru.clear();
+}
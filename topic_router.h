@@ -0,0 +1,204 @@
+#ifndef TOPIC_ROUTER_H
+#define TOPIC_ROUTER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "channel.h"
+
+/**
+ * @brief A published message as seen by subscribers.
+ *
+ * Subscribers receive a std::shared_ptr<const TopicMessage<T>>, so a message
+ * is stored once no matter how many subscribers it is delivered to.
+ */
+template <typename T>
+struct TopicMessage {
+    std::string topic;
+    T payload;
+};
+
+/**
+ * @brief Routes published messages to subscriber channels by hierarchical
+ * topic.
+ *
+ * Topics are '/'-separated levels such as "orders/eu/created". Subscription
+ * patterns may use two wildcards, each of which must fill a whole level:
+ * - '*' matches exactly one level.
+ * - '#' matches any number of remaining levels, including none, and must be
+ *   the last level ("orders/#" matches "orders" and "orders/eu/created").
+ *
+ * Subscriptions are indexed in a trie, so matching a topic costs time
+ * proportional to its depth rather than to the number of subscriptions. The
+ * match results of recently published topics are kept in a small LRU cache
+ * that is invalidated whenever the subscriptions change.
+ *
+ * @tparam T The type of the message payload.
+ */
+template <typename T>
+class TopicRouter {
+   public:
+    using Message = std::shared_ptr<const TopicMessage<T>>;
+    using SubscriptionId = uint64_t;
+
+    /**
+     * @brief Constructs a TopicRouter object.
+     * @param cache_capacity The number of topics whose match results are
+     * cached. If 0, every publish walks the trie.
+     */
+    explicit TopicRouter(size_t cache_capacity = 256)
+        : cache_capacity(cache_capacity) {}
+
+    // Disable copying and moving
+    TopicRouter(const TopicRouter&) = delete;
+    TopicRouter& operator=(const TopicRouter&) = delete;
+    TopicRouter(TopicRouter&&) = delete;
+    TopicRouter& operator=(TopicRouter&&) = delete;
+
+    // Destructor
+    ~TopicRouter() = default;
+
+    /**
+     * @brief Subscribes a channel to all topics matching a pattern.
+     * @param pattern The topic pattern, optionally containing '*' and '#'.
+     * @param ch The channel messages are delivered to. It must stay alive
+     * until the subscription is removed with unsubscribe().
+     * @return An id that can be passed to unsubscribe().
+     * @throws std::invalid_argument if '#' is not the last level or a
+     * wildcard is mixed with other characters in a level.
+     *
+     * Example: Channel<TopicRouter<Order>::Message> eu_orders(64);
+     *          router.subscribe("orders/eu/#", eu_orders);
+     */
+    SubscriptionId subscribe(const std::string& pattern, Channel<Message>& ch);
+
+    /**
+     * @brief Removes a subscription. Waits for publishes that are delivering
+     * to its channel, interrupting a publish blocked on the channel being
+     * full, so the channel may be destroyed as soon as this returns.
+     * @param id The id returned by subscribe().
+     * @return true if the subscription existed.
+     */
+    bool unsubscribe(SubscriptionId id);
+
+    /**
+     * @brief Publishes a message to every channel subscribed to a matching
+     * pattern. Blocks while a subscriber channel is full. A channel that is
+     * subscribed through several matching patterns receives the message once;
+     * closed channels are skipped.
+     * @param topic The topic of the message. Must not contain wildcards.
+     * @param payload The payload, stored once and shared by all subscribers.
+     * @return The number of channels the message was delivered to.
+     *
+     * Example: router.publish("orders/eu/created", order);
+     */
+    size_t publish(const std::string& topic, T payload);
+
+    /**
+     * @brief Returns the number of active subscriptions.
+     */
+    size_t subscription_count() const {
+        std::shared_lock<std::shared_mutex> lock(subs_mtx);
+        return subscriptions.size();
+    }
+
+    /**
+     * @brief Returns how many publishes were served from the match cache.
+     */
+    uint64_t cache_hits() const {
+        std::unique_lock<std::mutex> lock(cache_mtx);
+        return hits;
+    }
+
+   private:
+    /**
+     * @brief The delivery state of a subscription, shared by the match lists
+     * that refer to it so a cached list never points at a removed channel.
+     */
+    struct Subscriber {
+        explicit Subscriber(Channel<Message>& ch) : channel(&ch) {}
+
+        Channel<Message>* channel;
+        CancellationToken removed;  // Interrupts publishes blocked on channel
+        std::mutex mtx;
+        std::condition_variable idle;
+        size_t in_flight = 0;  // Publishes currently sending to channel
+    };
+
+    using MatchList = std::vector<std::shared_ptr<Subscriber>>;
+
+    struct Node {
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;
+        std::unique_ptr<Node> single;  // '*'
+        std::unique_ptr<Node> rest;    // '#'
+        std::vector<SubscriptionId> subscribers;
+    };
+
+    struct Subscription {
+        std::vector<std::string> levels;
+        std::shared_ptr<Subscriber> subscriber;
+    };
+
+    struct CacheEntry {
+        std::shared_ptr<const MatchList> matches;
+        typename std::list<std::string>::iterator lru_pos;
+    };
+
+    /**
+     * @brief Returns the slot of the child node for a pattern level, which is
+     * empty if the child doesn't exist yet.
+     */
+    static std::unique_ptr<Node>& child(Node& node, const std::string& level);
+
+    /**
+     * @brief Splits a topic or pattern into its levels.
+     */
+    static std::vector<std::string> split(const std::string& topic);
+
+    /**
+     * @brief Collects the subscribers of all patterns matching the levels.
+     * Must be called with subs_mtx held.
+     */
+    void match(const Node& node, const std::vector<std::string>& levels,
+               size_t depth, std::vector<SubscriptionId>& out) const;
+
+    /**
+     * @brief Delivers a message to one subscriber unless it was removed.
+     * @return true if the message was sent.
+     */
+    static bool deliver(Subscriber& subscriber, const Message& message);
+
+    /**
+     * @brief Looks up or computes the channels a topic is delivered to.
+     */
+    std::shared_ptr<const MatchList> lookup(const std::string& topic);
+
+    /**
+     * @brief Drops all cached match results. Must be called with subs_mtx
+     * held exclusively so no stale result can be inserted afterwards.
+     */
+    void invalidate_cache();
+
+    Node root;
+    std::unordered_map<SubscriptionId, Subscription> subscriptions;
+    SubscriptionId next_id = 1;
+    mutable std::shared_mutex subs_mtx;
+
+    std::unordered_map<std::string, CacheEntry> cache;
+    std::list<std::string> lru;  // Most recently used topic first
+    size_t cache_capacity;
+    uint64_t hits = 0;
+    mutable std::mutex cache_mtx;
+};
+
+#include "topic_router.cc"
+
+#endif  // TOPIC_ROUTER_H
@@ -0,0 +1,182 @@
+#include "topic_router.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+void log(const std::string& message) {
+    printf("[%llu] %s\n",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>{}(std::this_thread::get_id())),
+           message.c_str());
+}
+
+using Router = TopicRouter<std::string>;
+
+void test_wildcard_matching() {
+    log("Testing exact and wildcard subscriptions");
+    Router router;
+    Channel<Router::Message> exact(8), single(8), rest(8), all(8);
+
+    router.subscribe("orders/eu/created", exact);
+    router.subscribe("orders/*/created", single);
+    router.subscribe("orders/#", rest);
+    router.subscribe("#", all);
+
+    assert(router.publish("orders/eu/created", "o1") == 4);
+    assert(router.publish("orders/us/created", "o2") == 3);
+    assert(router.publish("orders/eu/created/late", "o3") == 2);
+    assert(router.publish("orders", "o4") == 2 &&
+           "'#' should match zero levels");
+    assert(router.publish("payments/eu", "p1") == 1);
+
+    assert(exact.size() == 1 && single.size() == 2 && rest.size() == 4 &&
+           all.size() == 5);
+    auto message = single.receive();
+    assert(message && (*message)->topic == "orders/eu/created" &&
+           (*message)->payload == "o1");
+    log("Wildcard matching test completed");
+}
+
+void test_shared_delivery() {
+    log("Testing reference-counted delivery");
+    Router router;
+    Channel<Router::Message> a(1), b(1);
+    router.subscribe("big/#", a);
+    router.subscribe("big/*", b);
+    // Overlapping patterns on the same channel deliver once
+    router.subscribe("big/payload", a);
+
+    assert(router.publish("big/payload", std::string(1 << 20, 'x')) == 2);
+    auto from_a = *a.receive();
+    auto from_b = *b.receive();
+    assert(from_a.get() == from_b.get() &&
+           "Subscribers should share a single copy of the message");
+    assert(from_a.use_count() == 2);
+    assert(a.is_empty() && "Duplicate delivery through overlapping patterns");
+    log("Shared delivery test completed");
+}
+
+void test_unsubscribe_and_cache() {
+    log("Testing unsubscribe and match cache invalidation");
+    Router router(4);
+    Channel<Router::Message> ch(64);
+    auto id = router.subscribe("metrics/*/cpu", ch);
+
+    for (int i = 0; i < 10; ++i) {
+        assert(router.publish("metrics/host1/cpu", "load") == 1);
+    }
+    assert(router.cache_hits() == 9 && "Repeated topic should hit the cache");
+
+    assert(router.unsubscribe(id));
+    assert(!router.unsubscribe(id) && "Second unsubscribe should fail");
+    assert(router.subscription_count() == 0);
+    assert(router.publish("metrics/host1/cpu", "load") == 0 &&
+           "Cache must not serve stale subscriptions");
+
+    router.subscribe("metrics/host1/cpu", ch);
+    assert(router.publish("metrics/host1/cpu", "load") == 1);
+
+    // More distinct topics than cache entries
+    for (int i = 0; i < 16; ++i) {
+        router.publish("metrics/host" + std::to_string(i) + "/cpu", "x");
+    }
+    log("Unsubscribe and cache test completed");
+}
+
+void test_invalid_patterns() {
+    log("Testing invalid patterns");
+    Router router;
+    Channel<Router::Message> ch(1);
+    for (const char* pattern : {"a/#/b", "a/b*", "a/#x"}) {
+        try {
+            router.subscribe(pattern, ch);
+            assert(false && "Expected exception was not thrown");
+        } catch (const std::invalid_argument& e) {
+            log("Caught expected exception: " + std::string(e.what()));
+        }
+    }
+    log("Invalid pattern test completed");
+}
+
+void test_concurrent_publishers() {
+    log("Testing concurrent publishers and subscribers");
+    Router router;
+    Channel<Router::Message> sink(1024);
+    router.subscribe("events/#", sink);
+
+    const int num_publishers = 4;
+    const int per_publisher = 500;
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < num_publishers; ++p) {
+        publishers.emplace_back([&router, p] {
+            for (int i = 0; i < per_publisher; ++i) {
+                router.publish("events/" + std::to_string(p % 2), "e");
+            }
+        });
+    }
+
+    int received = 0;
+    while (received < num_publishers * per_publisher) {
+        if (sink.receive()) received++;
+    }
+    for (auto& t : publishers) t.join();
+    log("Concurrent publishers test completed");
+}
+
+void test_unsubscribe_during_publish() {
+    log("Testing unsubscribe and destroy during publish");
+    Router router;
+
+    // A publish blocked on a full channel is interrupted by unsubscribe()
+    auto full = std::make_unique<Channel<Router::Message>>(1);
+    auto id = router.subscribe("jobs/#", *full);
+    assert(router.publish("jobs/1", "fills") == 1);
+    size_t delivered = 1;
+    std::thread blocked(
+        [&router, &delivered] { delivered = router.publish("jobs/2", "x"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(router.unsubscribe(id));
+    full.reset();  // Safe as soon as unsubscribe() returns
+    blocked.join();
+    assert(delivered == 0 && "Interrupted publish must not count");
+
+    // Subscribers come and go while publishers keep running
+    std::atomic<bool> done{false};
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < 4; ++p) {
+        publishers.emplace_back([&router, &done] {
+            while (!done) {
+                router.publish("jobs/new", "j");
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        auto ch = std::make_unique<Channel<Router::Message>>(2);
+        auto sub = router.subscribe("jobs/*", *ch);
+        ch->try_receive();
+        assert(router.unsubscribe(sub));
+    }
+    done = true;
+    for (auto& t : publishers) t.join();
+    log("Unsubscribe during publish test completed");
+}
+
+int main() {
+    log("Starting TopicRouter tests");
+
+    test_wildcard_matching();
+    test_shared_delivery();
+    test_unsubscribe_and_cache();
+    test_invalid_patterns();
+    test_concurrent_publishers();
+    test_unsubscribe_during_publish();
+
+    log("All tests completed successfully");
+    return 0;
+}